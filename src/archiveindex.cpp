@@ -0,0 +1,153 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "archiveindex.h"
+#include "settings.h"
+#include "utility.h"
+
+#include <QFile>
+#include <QFileInfo>
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+// playlist listing looks up archives on a worker thread
+static std::mutex &_mutex() {
+  static std::mutex m;
+
+  return m;
+}
+
+archiveIndex *archiveIndex::find(const QString &e, settings &settings) {
+  static std::map<QString, std::unique_ptr<archiveIndex>> indexes;
+
+  std::lock_guard<std::mutex> lock(_mutex());
+
+  if (e.isEmpty()) {
+
+    return nullptr;
+  }
+
+  auto path = e;
+
+  if (utility::isRelativePath(path)) {
+
+    path = settings.downloadFolder() + "/" + path;
+  }
+
+  path = QFileInfo(path).absoluteFilePath();
+
+  if (!QFile::exists(path)) {
+
+    return nullptr;
+  }
+
+  auto &m = indexes[path];
+
+  if (!m) {
+
+    m.reset(new archiveIndex(path));
+  }
+
+  m->refresh();
+
+  return m.get();
+}
+
+archiveIndex::archiveIndex(const QString &path) : m_path(path) {}
+
+bool archiveIndex::contains(const QString &archiveId) const {
+  std::lock_guard<std::mutex> lock(_mutex());
+
+  if (archiveId.isEmpty()) {
+
+    return false;
+
+  } else if (archiveId.contains(' ')) {
+
+    return m_keys.contains(archiveId.toUtf8());
+  } else {
+    return m_ids.contains(archiveId.toUtf8());
+  }
+}
+
+void archiveIndex::refresh() {
+  QFile file(m_path);
+
+  auto size = file.size();
+
+  if (size < m_size) {
+
+    // the archive was replaced, start over
+    m_keys.clear();
+    m_ids.clear();
+    m_size = 0;
+  }
+
+  if (size == m_size || !file.open(QIODevice::ReadOnly)) {
+
+    return;
+  }
+
+  auto data = file.map(m_size, size - m_size);
+
+  if (data) {
+
+    this->add(reinterpret_cast<const char *>(data), size - m_size);
+
+    file.unmap(data);
+  } else {
+    file.seek(m_size);
+
+    auto m = file.readAll();
+
+    this->add(m.constData(), m.size());
+  }
+}
+
+void archiveIndex::add(const char *data, qint64 size) {
+  qint64 start = 0;
+
+  for (qint64 i = 0; i < size; i++) {
+
+    if (data[i] != '\n') {
+
+      continue;
+    }
+
+    auto line = QByteArray(data + start, static_cast<int>(i - start)).trimmed();
+
+    start = i + 1;
+
+    auto space = line.lastIndexOf(' ');
+
+    if (space != -1) {
+
+      m_keys.insert(line);
+      m_ids.insert(line.mid(space + 1));
+    }
+  }
+
+  // a line still being written is read on the next refresh
+  m_size += start;
+}
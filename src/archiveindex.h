@@ -0,0 +1,63 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef ARCHIVEINDEX_H
+#define ARCHIVEINDEX_H
+
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+
+class settings;
+
+/*
+ * Index of the entries of a --download-archive file.
+ *
+ * The file is memory mapped and every "extractor id" line is put in a hash
+ * set, find() refreshes the index by reading only the lines appended since
+ * the last refresh. The index may be used from any thread.
+ */
+class archiveIndex {
+public:
+  /*
+   * Returns the index of the archive at "path", a relative path is taken to
+   * be relative to the download folder. Returns nullptr if there is no
+   * archive at the path.
+   */
+  static archiveIndex *find(const QString &path, settings &);
+  /*
+   * "archiveId" is an "extractor id" pair as written by yt-dlp, a lone id
+   * matches it under any extractor.
+   */
+  bool contains(const QString &archiveId) const;
+
+private:
+  archiveIndex(const QString &path);
+  void refresh();
+  void add(const char *data, qint64 size);
+  QString m_path;
+  qint64 m_size = 0;
+  QSet<QByteArray> m_keys;
+  QSet<QByteArray> m_ids;
+};
+
+#endif
@@ -50,6 +50,20 @@ basicdownloader::basicdownloader(const Context &ctx)
   connect(m_ui.pbResetBD, &QPushButton::clicked, this,
           &basicdownloader::resetView);
 
+  connect(m_ui.pbCancel, &QPushButton::clicked, [this]() {
+    if (m_waitingForBandwidth) {
+
+      // forgets the download that waits for bandwidth
+      m_waitingForBandwidth = false;
+
+      m_bandwidthWait++;
+
+      m_ui.pbCancel->setEnabled(false);
+
+      m_ui.pbResetBD->setEnabled(true);
+    }
+  });
+
   connect(m_ui.pbCustomFormatSelector, &QPushButton::clicked, this,
           &basicdownloader::showCustomFormatSelector);
 
@@ -91,16 +105,6 @@ basicdownloader::basicdownloader(const Context &ctx)
 
   // auto s = static_cast< void( QComboBox::* )( int ) >( &QComboBox::activated
   // ) ;
-
-  auto &table = m_bogusTable.get();
-
-  table.insertRow(0);
-
-  for (int s = 0; s < 3; s++) {
-
-    table.insertColumn(s);
-    table.setItem(0, s, new QTableWidgetItem);
-  }
 }
 
 void basicdownloader::init_done() {
@@ -333,8 +337,37 @@ void basicdownloader::download(const engines::engine &engine,
 
   m_tabManager.dumpCookie();
 
+  auto &budget = utility::bandwidthBudget::instance();
+
+  budget.release(m_bandwidthId);
+
+  if (!budget.available(m_settings)) {
+
+    // a rate given now could never grow, wait for other downloads instead
+    m_ctx.logger().add(tr("Waiting for other downloads to free bandwidth..."));
+
+    m_waitingForBandwidth = true;
+
+    auto wait = ++m_bandwidthWait;
+
+    budget.wait([this, &engine, args, urls, wait]() {
+      if (wait == m_bandwidthWait) {
+
+        m_waitingForBandwidth = false;
+
+        this->download(engine, args, urls, false);
+      }
+    });
+
+    return;
+  }
+
+  m_bandwidthId = utility::concurrentID();
+
+  auto rate = budget.acquire(m_bandwidthId, m_settings, 1);
+
   auto opts = utility::updateOptions(
-      {engine, ep, m_settings, args, QString(), false, urls});
+      {engine, ep, m_settings, args, QString(), false, urls, rate});
 
   this->run(engine, opts, args.quality(), false);
 }
@@ -350,6 +383,8 @@ void basicdownloader::run(const engines::engine &engine,
       [this](utility::ProcessExitState m, const basicdownloader::opts &opts) {
         opts.ctx.TabManager().enableAll();
 
+        utility::bandwidthBudget::instance().release(m_bandwidthId);
+
         m_ctx.logger().add(tr("Done"));
 
         m_ui.pbCancel->setEnabled(false);
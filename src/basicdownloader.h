@@ -81,9 +81,12 @@ private:
 	tabManager& m_tabManager ;
 	tableMiniWidget< int > m_tableList ;
 	QStringList m_optionsList ;
-	QTableWidget m_bogusTableOriginal ;
+	QTableView m_bogusTableOriginal ;
 	tableWidget m_bogusTable ;
 	utility::Terminator m_terminator ;
+	int m_bandwidthId = -1 ;
+	int m_bandwidthWait = 0 ;
+	bool m_waitingForBandwidth = false ;
 
 	void run( const engines::engine& engine,
 		  const QStringList& args,
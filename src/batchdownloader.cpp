@@ -22,23 +22,28 @@
 
 #include "batchdownloader.h"
 #include "tabmanager.h"
+#include "thumbnailcache.h"
 
 #include <QClipboard>
 #include <QFileDialog>
 #include <QMetaObject>
+#include <QScrollBar>
 #include <mainwindow.h>
 
 batchdownloader::batchdownloader(const Context &ctx)
     : m_ctx(ctx), m_settings(m_ctx.Settings()), m_ui(m_ctx.Ui()),
       m_mainWindow(m_ctx.mainWidget()), m_tabManager(m_ctx.TabManager()),
       m_showThumbnails(m_settings.showThumbnails()),
+      m_journal(QStandardPaths::writableLocation(QStandardPaths::DataLocation) +
+                QDir::separator() + "BatchDownloadsJournal.jsonl"),
       m_table(*m_ui.tableWidgetBD, m_ctx.mainWidget().font(), 1),
       m_tableWidgetBDList(*m_ui.TableWidgetBatchDownloaderList,
                           m_ctx.mainWidget().font()),
       m_debug(ctx.debug()),
       m_defaultVideoThumbnail(
           m_settings.defaultVideoThumbnailIcon(settings::tabName::batch)),
-      m_ccmd(m_ctx, *m_ui.pbBDCancel, m_settings) {
+      m_ccmd(m_ctx, *m_ui.pbBDCancel, m_settings),
+      m_prefetch(m_ctx, *m_ui.pbBDCancel, m_settings, false) {
   qRegisterMetaType<ItemEntry>();
 
   m_tableWidgetBDList.setTableWidget([]() {
@@ -50,19 +55,32 @@ batchdownloader::batchdownloader(const Context &ctx)
     return opts;
   }());
 
-  m_table.connect(&QTableWidget::currentItemChanged,
-                  [this](QTableWidgetItem *c, QTableWidgetItem *p) {
-                    m_table.selectRow(c, p, m_table.startPosition());
-                  });
-
   this->setThumbnailColumnSize(m_showThumbnails);
 
+  m_prioritiseTimer.setSingleShot(true);
+  m_prioritiseTimer.setInterval(300);
+
+  connect(&m_prioritiseTimer, &QTimer::timeout, [this]() {
+    if (networkAccess::hasNetworkSupport()) {
+
+      auto &network = m_ctx.versionInfo().network();
+
+      network.thumbnails().prioritise(m_table);
+    }
+  });
+
+  // thumbnails of the rows scrolled into view are fetched first
+  connect(m_table.get().verticalScrollBar(), &QScrollBar::valueChanged,
+          [this]() { m_prioritiseTimer.start(); });
+
   m_ui.pbBDDownload->setEnabled(false);
 
   m_ui.pbBDCancel->setEnabled(false);
 
   m_ui.BDFrame->hide();
 
+  this->restoreFromJournal();
+
   this->resetMenu();
 
   m_tableWidgetBDList.connect(&QTableWidget::itemClicked,
@@ -123,7 +141,7 @@ batchdownloader::batchdownloader(const Context &ctx)
           [this]() { this->download(this->defaultEngine()); });
 
   connect(m_ui.pbBDCancel, &QPushButton::clicked,
-          [this]() { m_terminator.terminateAll(m_table.get()); });
+          [this]() { m_terminator.terminateAll(m_table); });
 
   connect(m_ui.pbBDPasteClipboard, &QPushButton::clicked, [this]() {
     auto m = utility::clipboardText();
@@ -134,20 +152,19 @@ batchdownloader::batchdownloader(const Context &ctx)
     }
   });
 
-  m_table.connect(&QTableWidget::cellDoubleClicked,
-                  [this](int row, int column) {
-                    Q_UNUSED(column)
+  m_table.connect(&QTableView::doubleClicked, [this](const QModelIndex &m) {
+    auto row = m.row();
 
-                    const auto &engine = utility::resolveEngine(
-                        m_table, this->defaultEngine(), m_ctx.Engines(), row);
+    const auto &engine = utility::resolveEngine(m_table, this->defaultEngine(),
+                                                m_ctx.Engines(), row);
 
-                    m_ctx.Engines().openUrls(m_table, row, engine);
-                  });
+    m_ctx.Engines().openUrls(m_table, row, engine);
+  });
 
   // auto s = static_cast< void( QComboBox::* )( int ) >( &QComboBox::activated
   // ) ;
 
-  m_table.connect(&QTableWidget::customContextMenuRequested, [this](QPoint) {
+  m_table.connect(&QTableView::customContextMenuRequested, [this](QPoint) {
     auto row = m_table.currentRow();
 
     auto function = [this](const utility::contextState &c) {
@@ -157,6 +174,8 @@ batchdownloader::batchdownloader(const Context &ctx)
 
       } else if (c.clear()) {
 
+        m_ctx.versionInfo().network().thumbnails().cancel(m_table);
+
         m_table.clear();
       }
     };
@@ -211,6 +230,10 @@ batchdownloader::batchdownloader(const Context &ctx)
     ac->setEnabled(m_table.noneAreRunning());
 
     connect(ac, &QAction::triggered, [this, row]() {
+      auto &thumbnails = m_ctx.versionInfo().network().thumbnails();
+
+      thumbnails.cancel(m_table, m_table.url(row));
+
       m_table.removeRow(row);
 
       m_ui.pbBDDownload->setEnabled(m_table.rowCount());
@@ -314,8 +337,10 @@ batchdownloader::batchdownloader(const Context &ctx)
                                function);
   });
 
-  connect(m_ui.pbBDCancel, &QPushButton::clicked,
-          [this]() { m_ccmd.cancelled(); });
+  connect(m_ui.pbBDCancel, &QPushButton::clicked, [this]() {
+    m_ccmd.cancelled();
+    m_prefetch.cancelled();
+  });
 
   connect(m_ui.pbBDAdd, &QPushButton::clicked, [this]() {
     auto m = m_ui.lineEditBDUrl->text();
@@ -329,7 +354,13 @@ batchdownloader::batchdownloader(const Context &ctx)
   });
 }
 
-batchdownloader::~batchdownloader() { this->saveBatchDownloadList(m_table); }
+batchdownloader::~batchdownloader() {
+  this->saveBatchDownloadList(m_table);
+
+  // the journal is only needed to recover from a session that did not end
+  // cleanly
+  m_journal.cleared();
+}
 
 void batchdownloader::init_done() {}
 
@@ -373,20 +404,159 @@ void batchdownloader::gotEvent(const QByteArray &m) {
   QJsonParseError err;
   auto jsonDoc = QJsonDocument::fromJson(m, &err);
 
-  if (err.error == QJsonParseError::NoError) {
+  QStringList urls;
 
+  auto autoDownload = false;
+  auto showThumbnail = false;
+
+  if (err.error != QJsonParseError::NoError) {
+
+    // bulk lists are sent as a json array or through the "bulk" rpc method,
+    // plain text is not taken to be a list of urls
+    auto e = QString("Ignored a message that is not json: %1")
+                 .arg(err.errorString());
+
+    m_ctx.logger().add(e.toUtf8(), -1);
+
+    return;
+
+  } else if (jsonDoc.isArray()) {
+
+    for (const auto &it : jsonDoc.array()) {
+
+      urls.append(it.toString());
+    }
+  } else {
     QJsonObject jsonArgs = jsonDoc.object();
 
     auto url = jsonArgs.value("-u").toString();
 
     if (!url.isEmpty()) {
 
-      m_ui.tabWidget->setCurrentIndex(1);
+      urls.append(url);
+    }
+
+    autoDownload = jsonArgs.value("-a").toBool(false);
+    showThumbnail = jsonArgs.value("-s").toBool(false);
+  }
+
+  urls.removeAll(QString());
+
+  if (urls.isEmpty()) {
+
+    return;
+  }
+
+  m_ui.tabWidget->setCurrentIndex(1);
+
+  auto admitted = this->admit(urls, autoDownload, showThumbnail);
+
+  if (admitted < static_cast<size_t>(urls.size())) {
+
+    auto s = static_cast<size_t>(urls.size()) - admitted;
+
+    auto e = QString("Batch list queue is full, %1 urls were not added").arg(s);
+
+    m_ctx.logger().add(e.toUtf8(), -1);
+  }
+}
+
+size_t batchdownloader::admit(const QStringList &urls, bool autoDownload,
+                              bool showThumbnails) {
+  auto credit = this->admissionCredit();
+
+  size_t admitted = 0;
+
+  for (const auto &it : urls) {
+
+    if (admitted == credit) {
+
+      break;
+    }
+
+    if (!it.isEmpty()) {
+
+      m_admission.push_back({it, autoDownload, showThumbnails});
+
+      admitted++;
+    }
+  }
+
+  this->admitNext();
+
+  return admitted;
+}
+
+size_t batchdownloader::admissionCredit() {
+  auto size = m_settings.admissionQueueSize();
+
+  if (m_admission.size() < size) {
+
+    return size - m_admission.size();
+  } else {
+    return 0;
+  }
+}
+
+void batchdownloader::whenAdmissionCredit(
+    std::function<void(size_t)> function) {
+  if (m_admission.size() <= m_settings.admissionQueueSize() / 2) {
+
+    function(this->admissionCredit());
+  } else {
+    m_creditWaiters.emplace_back(std::move(function));
+  }
+}
+
+void batchdownloader::admitNext() {
+  auto max = m_settings.maxConcurrentMetadataFetches();
+
+  auto batchSize = m_settings.metadataBatchSize();
+
+  // urls are added while the prefetch stage has room for their batches
+  while (!m_admission.empty() && m_metadataPending < max) {
+
+    auto e = m_admission.front();
+
+    m_admission.pop_front();
 
-      auto autoDownload = jsonArgs.value("-a").toBool(false);
-      auto showThumbnail = jsonArgs.value("-s").toBool(false);
+    Items items(e.url);
 
-      this->addToList(url, autoDownload, showThumbnail);
+    // a single url that is downloaded right away has no metadata to fetch
+    if (!e.autoDownload || e.showThumbnails) {
+
+      while (items.size() < batchSize && !m_admission.empty()) {
+
+        const auto &m = m_admission.front();
+
+        if (m.autoDownload != e.autoDownload ||
+            m.showThumbnails != e.showThumbnails) {
+
+          break;
+        }
+
+        items.add(m.url);
+
+        m_admission.pop_front();
+      }
+    }
+
+    this->showThumbnail(this->defaultEngine(), std::move(items),
+                        e.autoDownload, e.showThumbnails);
+  }
+
+  if (!m_creditWaiters.empty() &&
+      m_admission.size() <= m_settings.admissionQueueSize() / 2) {
+
+    auto credit = this->admissionCredit();
+
+    auto waiters = std::move(m_creditWaiters);
+
+    m_creditWaiters.clear();
+
+    for (const auto &it : waiters) {
+
+      it(credit);
     }
   }
 }
@@ -428,18 +598,17 @@ void batchdownloader::showThumbnail(const engines::engine &engine, Items list,
 
     m_table.selectLast();
 
-    downloadManager::index index(m_table);
+    this->downloadFetched(engine, {row});
 
-    index.add(row, m_ui.lineEditBDUrlOptions->text());
+  } else if (m_showThumbnails && engine.likeYoutubeDl()) {
 
-    this->download(engine, std::move(index));
+    auto batchSize = m_settings.metadataBatchSize();
 
-  } else if (m_showThumbnails && engine.likeYoutubeDl()) {
+    std::vector<int> rows;
+    QStringList urls;
 
     for (const auto &it : list) {
 
-      downloadManager::index indexes(m_table);
-
       auto state = downloadManager::finishedStatus::running();
 
       auto uiText = it.uiText;
@@ -470,16 +639,22 @@ void batchdownloader::showThumbnail(const engines::engine &engine, Items list,
 
       m_table.selectLast();
 
-      indexes.add(row, m_ui.lineEditBDUrlOptions->text());
+      rows.emplace_back(row);
+      urls.append(it.url);
+
+      if (rows.size() == batchSize) {
+
+        this->showThumbnails(engine, std::move(rows), std::move(urls),
+                             autoDownload);
+        rows.clear();
+        urls.clear();
+      }
+    }
 
-      auto url = it.url;
+    if (!rows.empty()) {
 
-      m_ccmd.download(
-          std::move(indexes), engine,
-          [this]() { return m_settings.maxConcurrentDownloads(); }(),
-          [this, url, autoDownload](const engines::engine &engine, int index) {
-            this->showThumbnail(engine, index, url, autoDownload);
-          });
+      this->showThumbnails(engine, std::move(rows), std::move(urls),
+                           autoDownload);
     }
   } else {
     this->addItemUiSlot({engine, std::move(list)});
@@ -491,7 +666,7 @@ void batchdownloader::addItemUiSlot(ItemEntry m) {
 
     auto s = m.next();
 
-    this->addItemUi(m_defaultVideoThumbnail, -1, false, {s.uiText, s.url});
+    this->addItemUi(-1, false, {s.uiText, s.url});
 
     QMetaObject::invokeMethod(this, "addItemUiSlot", Qt::QueuedConnection,
                               Q_ARG(ItemEntry, m));
@@ -519,6 +694,38 @@ void batchdownloader::saveBatchDownloadList(tableWidget &t_tableWidget) {
                  QDir::separator() + "BatchDownloadsState.json");
 }
 
+void batchdownloader::restoreFromJournal() {
+  std::vector<tableWidget::entry> entries;
+
+  for (const auto &it : m_journal.load()) {
+
+    tableWidget::entry e(m_defaultVideoThumbnail, it.uiText, it.url,
+                         it.runningState);
+
+    e.downloadingOptions = it.downloadingOptions;
+    e.downloadingOptionsUi = it.downloadingOptionsUi;
+    e.engineName = it.engineName;
+
+    entries.emplace_back(std::move(e));
+  }
+
+  m_table.reset(std::move(entries));
+
+  m_table.setJournal(&m_journal);
+
+  using df = downloadManager::finishedStatus;
+
+  for (int row = 0; row < m_table.rowCount(); row++) {
+
+    if (df::running(m_table.runningState(row))) {
+
+      m_table.setRunningState(df::notStarted(), row);
+    }
+  }
+
+  m_ui.pbBDDownload->setEnabled(m_table.rowCount());
+}
+
 void batchdownloader::loadListFromLastSession(QMenu &m) {
   auto ac_load = m.addAction(QObject::tr("Load List from Last Session"));
   QObject::connect(ac_load, &QAction::triggered, this, [this]() {
@@ -586,41 +793,244 @@ const engines::engine &batchdownloader::defaultEngine() {
   return m_ctx.Engines().defaultEngine(this->defaultEngineName());
 }
 
-void batchdownloader::showThumbnail(const engines::engine &engine, int index,
-                                    const QString &url, bool autoDownload) {
-  auto aa = [&engine, index, this, url,
-             autoDownload](utility::ProcessExitState e,
-                           const batchdownloader::opts &opts) {
-    auto aa = [this, autoDownload](const engines::engine &engine, int index) {
-      this->showThumbnail(engine, index, {}, autoDownload);
+void batchdownloader::showThumbnails(const engines::engine &engine,
+                                     std::vector<int> rows, QStringList urls,
+                                     bool autoDownload) {
+  auto row = rows[0];
+
+  m_metadataBatches[row] = {std::move(rows), std::move(urls), autoDownload};
+
+  m_metadataPending++;
+
+  auto options = m_ui.lineEditBDUrlOptions->text();
+
+  // the prefetch stage keeps one run going that batches are added to
+  if (m_prefetch.running()) {
+
+    m_prefetch.append(row, options);
+  } else {
+    downloadManager::index indexes(m_table);
+
+    indexes.add(row, options);
+
+    m_prefetch.download(std::move(indexes), engine,
+                        m_settings.maxConcurrentMetadataFetches(),
+                        [this](const engines::engine &engine, int index) {
+                          this->showThumbnails(engine, index);
+                        });
+  }
+}
+
+void batchdownloader::downloadFetched(const engines::engine &engine,
+                                      const std::vector<int> &rows) {
+  if (m_ccmd.running()) {
+
+    for (auto row : rows) {
+
+      auto u = m_table.downloadingOptions(row);
+
+      m_ccmd.append(row, u.isEmpty() ? m_ui.lineEditBDUrlOptions->text() : u);
+    }
+  } else {
+    downloadManager::index indexes(m_table);
+
+    for (auto row : rows) {
+
+      auto u = m_table.downloadingOptions(row);
+
+      indexes.add(row, u.isEmpty() ? m_ui.lineEditBDUrlOptions->text() : u);
+    }
+
+    this->download(engine, std::move(indexes));
+  }
+}
+
+/*
+ * Splits concatenated json objects, the engine prints one object per url.
+ */
+static std::vector<QByteArray> _jsonObjects(const QByteArray &data) {
+  std::vector<QByteArray> m;
+
+  int depth = 0;
+  int start = 0;
+  bool inString = false;
+  bool escaped = false;
+
+  for (int i = 0; i < data.size(); i++) {
+
+    auto c = data[i];
+
+    if (inString) {
+
+      if (escaped) {
+
+        escaped = false;
+
+      } else if (c == '\\') {
+
+        escaped = true;
+
+      } else if (c == '"') {
+
+        inString = false;
+      }
+    } else if (c == '"') {
+
+      inString = true;
+
+    } else if (c == '{') {
+
+      if (depth == 0) {
+
+        start = i;
+      }
+
+      depth++;
+
+    } else if (c == '}' && depth > 0) {
+
+      depth--;
+
+      if (depth == 0) {
+
+        m.emplace_back(data.mid(start, i - start + 1));
+      }
+    }
+  }
+
+  return m;
+}
+
+/*
+ * Matches the objects to the urls they were fetched for by "original_url" or
+ * "webpage_url". Objects are never given to a url by their position, a url
+ * that prints nothing would shift every later object into the wrong row.
+ * Urls without a match are left empty and are added without metadata, the
+ * entries of a playlist url after its first one are dropped.
+ */
+static std::vector<QByteArray> _metadata(const QStringList &urls,
+                                         const QByteArray &data) {
+  std::vector<QByteArray> m(static_cast<size_t>(urls.size()));
+
+  for (auto &it : _jsonObjects(data)) {
+
+    auto obj = QJsonDocument::fromJson(it).object();
+
+    auto original = obj.value("original_url").toString();
+    auto webpage = obj.value("webpage_url").toString();
+
+    for (int i = 0; i < urls.size(); i++) {
+
+      auto &e = m[static_cast<size_t>(i)];
+
+      if (e.isEmpty() && (urls[i] == original || urls[i] == webpage)) {
+
+        e = std::move(it);
+
+        break;
+      }
+    }
+  }
+
+  return m;
+}
+
+void batchdownloader::showThumbnails(const engines::engine &engine,
+                                     int index) {
+  auto it = m_metadataBatches.find(index);
+
+  if (it == m_metadataBatches.end()) {
+
+    return;
+  }
+
+  const auto &batch = it->second;
+
+  auto aa = [&engine, index, this](utility::ProcessExitState e,
+                                   const batchdownloader::opts &opts) {
+    auto aa = [this](const engines::engine &engine, int index) {
+      this->showThumbnails(engine, index);
     };
 
-    auto bb = [this, &engine, &opts, url,
-               autoDownload](const downloadManager::finishedStatus &f) {
+    auto bb = [this, &engine, &opts,
+               index](const downloadManager::finishedStatus &f) {
+      auto it = m_metadataBatches.find(index);
+
+      if (it == m_metadataBatches.end()) {
+
+        return;
+      }
+
+      auto batch = std::move(it->second);
+
+      m_metadataBatches.erase(it);
+
+      m_metadataPending--;
+
       auto allFinished = f.allFinished();
+      auto cancelled = f.exitState().cancelled();
 
-      if (f.exitState().cancelled()) {
+      // downloads keep the ui disabled until they are done
+      auto enableUi = allFinished && !m_ccmd.running();
 
-        this->addItem(f.index(), allFinished, url);
-      } else {
-        utility::MediaEntry m(url, opts.batchLogger.data());
+      std::vector<QByteArray> metadata;
+
+      if (!cancelled) {
+
+        metadata = _metadata(batch.urls, opts.batchLogger.data());
+      }
+
+      for (size_t i = 0; i < batch.rows.size(); i++) {
+
+        auto row = batch.rows[i];
+        const auto &url = batch.urls[static_cast<int>(i)];
+
+        auto enableAll = enableUi && i + 1 == batch.rows.size();
 
-        if (m.valid()) {
+        if (cancelled || metadata[i].isEmpty()) {
 
-          this->addItem(f.index(), allFinished, std::move(m));
+          this->addItem(row, enableAll, url);
         } else {
-          this->addItem(f.index(), allFinished, url);
+          utility::MediaEntry m(url, metadata[i]);
+
+          if (m.valid()) {
+
+            this->addItem(row, enableAll, std::move(m));
+          } else {
+            this->addItem(row, enableAll, url);
+          }
         }
+      }
+
+      // fetched rows start downloading while later batches are still
+      // being fetched
+      if (!cancelled && batch.autoDownload) {
+
+        this->downloadFetched(engine, batch.rows);
+      }
+
+      if (allFinished) {
+
+        // batches of a cancelled run that never started
+        for (const auto &m : m_metadataBatches) {
 
-        if (allFinished && autoDownload) {
+          for (size_t i = 0; i < m.second.rows.size(); i++) {
 
-          this->download(engine);
+            this->addItem(m.second.rows[i], false,
+                          m.second.urls[static_cast<int>(i)]);
+          }
         }
+
+        m_metadataBatches.clear();
+
+        m_metadataPending = 0;
       }
     };
 
-    m_ccmd.monitorForFinished(engine, index, std::move(e), std::move(aa),
-                              std::move(bb));
+    m_prefetch.monitorForFinished(engine, index, std::move(e), std::move(aa),
+                                  std::move(bb));
+
+    this->admitNext();
   };
 
   auto functions = utility::OptionsFunctions(
@@ -633,12 +1043,13 @@ void batchdownloader::showThumbnail(const engines::engine &engine, int index,
       },
       std::move(aa));
 
-  //  auto m = m_ui.lineEditBDUrlOptions->text();
-
   BatchLoggerWrapper wrapper(m_ctx.logger());
 
   auto dumpjsonArgs = engine.dumpJsonArguments();
 
+  dumpjsonArgs.append(
+      utility::infoJsonCache::writeArguments(engine, m_settings));
+
   m_tabManager.dumpCookie();
 
   const QString cookiePath = m_settings.cookieFilePath(engine.name());
@@ -649,8 +1060,14 @@ void batchdownloader::showThumbnail(const engines::engine &engine, int index,
     dumpjsonArgs.append(cookiePath);
   }
 
-  m_ccmd.download(
-      engine, dumpjsonArgs, index == -1 ? url : m_table.url(index),
+  // the last url is appended by downloadManager
+  for (int i = 0; i + 1 < batch.urls.size(); i++) {
+
+    dumpjsonArgs.append(batch.urls[i]);
+  }
+
+  m_prefetch.download(
+      engine, dumpjsonArgs, batch.urls.last(),
       m_terminator.setUp(m_ui.pbBDCancel, &QPushButton::clicked, index),
       batchdownloader::make_options({m_ctx, m_debug, false, index, wrapper},
                                     std::move(functions)),
@@ -674,15 +1091,15 @@ void batchdownloader::setThumbnailColumnSize(bool e) {
 }
 
 void batchdownloader::clearScreen() {
+  m_ctx.versionInfo().network().thumbnails().cancel(m_table);
+
   m_table.clear();
   m_ui.lineEditBDUrlOptions->clear();
   m_ui.lineEditBDUrl->clear();
 }
 
 void batchdownloader::showList() {
-  auto &table = m_table.get();
-
-  auto row = table.currentRow();
+  auto row = m_table.currentRow();
 
   if (row == -1) {
 
@@ -755,18 +1172,24 @@ void batchdownloader::showList() {
   utility::run(args, QString(), std::move(ctx));
 }
 
-static int _addItemUi(const QPixmap &pixmap, int index, tableWidget &table,
-                      Ui::MainWindow &ui, const utility::MediaEntry &media) {
+static int _addItemUi(const QPixmap &pixmap, const QString &thumbnailKey,
+                      int index, tableWidget &table, Ui::MainWindow &ui,
+                      const utility::MediaEntry &media) {
   auto state = downloadManager::finishedStatus::notStarted();
 
+  tableWidget::entry entry(pixmap, media.uiText(), media.url(), state);
+
+  entry.thumbnail.key = thumbnailKey;
+  entry.archiveId = media.archiveId();
+
   int row;
   if (index == -1) {
 
-    row = table.addItem({pixmap, media.uiText(), media.url(), state});
+    row = table.addItem(std::move(entry));
     table.selectLast();
   } else {
     row = index;
-    table.replace({pixmap, media.uiText(), media.url(), state}, index);
+    table.replace(std::move(entry), index);
   }
 
   ui.lineEditBDUrl->clear();
@@ -776,10 +1199,11 @@ static int _addItemUi(const QPixmap &pixmap, int index, tableWidget &table,
   return row;
 }
 
-void batchdownloader::addItemUi(const QPixmap &pixmap, int index,
+void batchdownloader::addItemUi(const QString &thumbnailKey, int index,
                                 bool enableAll,
                                 const utility::MediaEntry &media) {
-  auto row = _addItemUi(pixmap, index, m_table, m_ui, media);
+  auto row = _addItemUi(m_defaultVideoThumbnail, thumbnailKey, index, m_table,
+                        m_ui, media);
 
   m_ctx.TabManager().Configure().setDownloadOptions(row, m_table);
 
@@ -794,45 +1218,45 @@ void batchdownloader::addItemUi(const QPixmap &pixmap, int index,
 
 void batchdownloader::addItemUi(int index, bool enableAll,
                                 const utility::MediaEntry &media) {
-  this->addItemUi(m_defaultVideoThumbnail, index, enableAll, media);
+  this->addItemUi(QString(), index, enableAll, media);
 }
 
 void batchdownloader::addItem(int index, bool enableAll,
                               const utility::MediaEntry &media) {
+  if (media.valid()) {
+
+    utility::infoJsonCache::save(media);
+  }
+
   if (media.thumbnailUrl().isEmpty()) {
 
     this->addItemUi(index, enableAll, media);
   } else {
-    if (networkAccess::hasNetworkSupport()) {
-
-      auto &network = m_ctx.versionInfo().network();
-
-      m_networkRunning++;
+    const auto &u = media.thumbnailUrl();
 
-      const auto &u = media.thumbnailUrl();
+    auto w =
+        static_cast<int>(m_settings.thumbnailWidth(settings::tabName::batch));
+    auto h =
+        static_cast<int>(m_settings.thumbnailHeight(settings::tabName::batch));
 
-      network.getResource(u, [this, media, index](const QByteArray &data) {
-        QPixmap pixmap;
+    auto key = thumbnailCache::key(u, w, h);
 
-        if (pixmap.loadFromData(data)) {
+    if (thumbnailCache::instance().contains(key)) {
 
-          auto w = m_settings.thumbnailWidth(settings::tabName::batch);
-          auto h = m_settings.thumbnailHeight(settings::tabName::batch);
+      this->addItemUi(key, index, enableAll, media);
 
-          pixmap = pixmap.scaled(w, h, Qt::KeepAspectRatio,
-                                 Qt::SmoothTransformation);
+    } else if (networkAccess::hasNetworkSupport()) {
 
-        } else {
-          pixmap = m_defaultVideoThumbnail;
-        }
+      auto &network = m_ctx.versionInfo().network();
 
-        _addItemUi(pixmap, index, m_table, m_ui, media);
+      m_networkRunning++;
 
-        m_ctx.TabManager().Configure().setDownloadOptions(index, m_table);
+      auto rowUrl = index == -1 ? media.url() : m_table.url(index);
 
+      auto finish = [this]() {
         if (m_table.noneAreRunning()) {
 
-          m_ui.pbBDDownload->setEnabled(true);
+          m_ui.pbBDDownload->setEnabled(m_table.rowCount());
 
           m_ctx.TabManager().enableAll();
 
@@ -840,7 +1264,34 @@ void batchdownloader::addItem(int index, bool enableAll,
         }
 
         m_networkRunning--;
-      });
+      };
+
+      auto done = [this, media, index, key, finish](bool decoded) {
+        auto thumbnailKey = decoded ? key : QString();
+
+        _addItemUi(m_defaultVideoThumbnail, thumbnailKey, index, m_table, m_ui,
+                   media);
+
+        m_ctx.TabManager().Configure().setDownloadOptions(index, m_table);
+
+        finish();
+      };
+
+      auto &thumbnails = network.thumbnails();
+
+      thumbnails.fetch(m_table, rowUrl, u,
+                       [key, w, h, done, finish](const QByteArray &data,
+                                                 bool cancelled) {
+                         if (cancelled) {
+
+                           // the row was removed, only the ui is restored
+                           finish();
+                         } else {
+                           auto &cache = thumbnailCache::instance();
+
+                           cache.add(key, data, w, h, done);
+                         }
+                       });
     } else {
       this->addItemUi(index, enableAll, media);
     }
@@ -874,13 +1325,93 @@ void batchdownloader::download(const engines::engine &engine,
       });
 }
 
+std::vector<int> batchdownloader::enqueue(const QStringList &urls,
+                                          const QString &options,
+                                          bool download) {
+  std::vector<int> rows;
+  std::vector<tableWidget::entry> entries;
+
+  auto state = downloadManager::finishedStatus::notStarted();
+
+  for (const auto &it : urls) {
+
+    if (it.isEmpty()) {
+
+      continue;
+    }
+
+    tableWidget::entry e(m_defaultVideoThumbnail, it, it, state);
+
+    e.downloadingOptions = options;
+
+    entries.emplace_back(std::move(e));
+  }
+
+  if (entries.empty()) {
+
+    return rows;
+  }
+
+  auto first = m_table.addItems(std::move(entries));
+
+  for (int row = first; row < m_table.rowCount(); row++) {
+
+    rows.emplace_back(row);
+  }
+
+  m_ui.pbBDDownload->setEnabled(true);
+
+  if (!download) {
+
+    return rows;
+  }
+
+  this->downloadFetched(this->defaultEngine(), rows);
+
+  return rows;
+}
+
+bool batchdownloader::startQueued() {
+  if (!m_ccmd.running()) {
+
+    this->download(this->defaultEngine());
+
+    return true;
+  } else {
+    return false;
+  }
+}
+
+void batchdownloader::cancel(int row) {
+  if (row == -1) {
+
+    m_ccmd.cancelled();
+    m_prefetch.cancelled();
+
+    m_terminator.terminateAll(m_table);
+  } else {
+    m_terminator.terminate(row);
+  }
+}
+
 void batchdownloader::download(const engines::engine &engine) {
+  // rows whose metadata is still being fetched are downloaded once it is
+  for (auto &it : m_metadataBatches) {
+
+    it.second.autoDownload = true;
+  }
+
   downloadManager::index indexes(m_table);
 
   for (int s = 0; s < m_table.rowCount(); s++) {
 
     auto e = m_table.runningState(s);
 
+    if (downloadManager::finishedStatus::running(e)) {
+
+      continue;
+    }
+
     if (!downloadManager::finishedStatus::finishedWithSuccess(e)) {
 
       auto u = m_table.downloadingOptions(s);
@@ -31,6 +31,10 @@
 #include <QString>
 #include <QStringList>
 
+#include <deque>
+#include <functional>
+#include <map>
+
 class tabManager;
 
 class Items {
@@ -102,10 +106,44 @@ public:
   void gotEvent(const QByteArray &);
   //	void updateEnginesList( const QStringList& ) ;
   void setThumbnailColumnSize(bool);
+  std::vector<int> enqueue(const QStringList &urls, const QString &options,
+                           bool download);
+  bool startQueued();
+  void cancel(int row);
+  tableWidget &table() { return m_table; }
+  /*
+   * Queues urls to be added to the list, the queue holds at most
+   * admissionQueueSize() urls and they are added as metadata processes
+   * finish. Returns the number of urls that were queued.
+   */
+  size_t admit(const QStringList &urls, bool autoDownload,
+               bool showThumbnails);
+  size_t admissionCredit();
+  /*
+   * "function" is called with the free space of the queue once at least
+   * half of it is free.
+   */
+  void whenAdmissionCredit(std::function<void(size_t)> function);
 private slots:
   void addItemUiSlot(ItemEntry);
 
 private:
+  void admitNext();
+  struct admission {
+    QString url;
+    bool autoDownload;
+    bool showThumbnails;
+  };
+  /*
+   * Rows whose metadata is fetched by one engine process of the prefetch
+   * stage, keyed by the first row.
+   */
+  struct metadataBatch {
+    std::vector<int> rows;
+    QStringList urls;
+    bool autoDownload;
+  };
+  std::map<int, metadataBatch> m_metadataBatches;
   void getListFromFile(QMenu &);
   QString defaultEngineName();
   const engines::engine &defaultEngine();
@@ -118,8 +156,12 @@ private:
   void download(const engines::engine &, int);
   void addItem(int, bool, const utility::MediaEntry &);
   void addItemUi(int, bool, const utility::MediaEntry &);
-  void addItemUi(const QPixmap &pixmap, int, bool, const utility::MediaEntry &);
-  void showThumbnail(const engines::engine &, int, const QString &url, bool);
+  void addItemUi(const QString &thumbnailKey, int, bool,
+                 const utility::MediaEntry &);
+  void showThumbnails(const engines::engine &, std::vector<int> rows,
+                      QStringList urls, bool autoDownload);
+  void showThumbnails(const engines::engine &, int);
+  void downloadFetched(const engines::engine &, const std::vector<int> &rows);
 
   void showThumbnail(const engines::engine &, Items, bool = false,
                      bool = false);
@@ -130,33 +172,51 @@ private:
   QWidget &m_mainWindow;
   tabManager &m_tabManager;
   bool m_showThumbnails;
+  tableJournal m_journal;
   tableWidget m_table;
   tableMiniWidget<int> m_tableWidgetBDList;
   QString m_debug;
   int m_networkRunning = false;
+  size_t m_metadataPending = 0;
+  std::deque<admission> m_admission;
+  std::vector<std::function<void(size_t)>> m_creditWaiters;
   QStringList m_optionsList;
   QLineEdit m_lineEdit;
   QPixmap m_defaultVideoThumbnail;
+  QTimer m_prioritiseTimer;
 
   utility::Terminator m_terminator;
 
   downloadManager m_ccmd;
+  downloadManager m_prefetch;
 
   class BatchLogger {
   public:
-    BatchLogger(Logger &l) : m_logger(l), m_id(utility::concurrentID()) {}
+    BatchLogger(Logger &l) : m_logger(l), m_id(utility::concurrentID()) {
+      // the metadata of the batch is parsed from the json lines when it
+      // finishes, they are set aside when the log limits drop them
+      m_logger.limit(m_lines, [this](const QByteArray &e) {
+        if (e.startsWith('{')) {
+
+          m_json += e;
+        }
+      });
+    }
+    BatchLogger(const BatchLogger &) = delete;
     void add(const QString &e) { this->add(e.toUtf8()); }
     void add(const QByteArray &e) { m_logger.add(e, m_id); }
     void clear() {}
+    void flush() { m_logger.flush(); }
     template <typename Function> void add(const Function &function) {
       m_logger.add(function, m_id);
       function(m_lines, m_id, false);
     }
     void logError(const QByteArray &data) { m_logger.logError(data, m_id); }
-    QByteArray data() const { return m_lines.toLine(); }
+    QByteArray data() const { return m_json + m_lines.toLine(); }
 
   private:
     Logger::Data m_lines;
+    QByteArray m_json;
     Logger &m_logger;
     int m_id;
   };
@@ -167,6 +227,7 @@ private:
         : m_logger(std::make_shared<BatchLogger>(l)) {}
     void add(const QByteArray &e) { m_logger->add(e); }
     void clear() { m_logger->clear(); }
+    void flush() { m_logger->flush(); }
     template <typename Function> void add(const Function &function) {
       m_logger->add(function);
     }
@@ -193,6 +254,7 @@ private:
   }
   void processSavedBtachDownloadFile(const QString &filePath);
   void saveBatchDownloadList(tableWidget &t_tableWidget);
+  void restoreFromJournal();
   void loadListFromLastSession(QMenu &m);
 };
 
@@ -21,6 +21,7 @@
  */
 
 #include "downloadmanager.h"
+#include "archiveindex.h"
 #include "tabmanager.h"
 
 void downloadManager::uiEnableAll(bool e) {
@@ -30,3 +31,126 @@ void downloadManager::uiEnableAll(bool e) {
     m_ctx.TabManager().disableAll();
   }
 }
+
+bool downloadManager::archived(QStringList &options, int row) {
+  const auto &id = m_index->table().archiveId(row);
+
+  if (id.isEmpty()) {
+
+    return false;
+  }
+
+  auto path = utility::arguments(options).hasValue("--download-archive");
+
+  auto archive = archiveIndex::find(path, m_settings);
+
+  return archive && archive->contains(id);
+}
+
+bool downloadManager::bandwidthAvailable() {
+  auto &budget = utility::bandwidthBudget::instance();
+
+  if (budget.available(m_settings)) {
+
+    return true;
+  }
+
+  if (!m_waitingForBandwidth) {
+
+    m_waitingForBandwidth = true;
+
+    // entries left waiting start once another process gives up its rate
+    budget.wait([this]() {
+      m_waitingForBandwidth = false;
+
+      if (m_engine && m_index.created() && !m_cancelled) {
+
+        this->startDownloads(*m_engine, m_function);
+      }
+    });
+  }
+
+  return false;
+}
+
+void downloadManager::startAdaptiveConcurrency() {
+  m_adaptive = true;
+  m_slots = std::min(m_maxConcurrency, size_t(1));
+  m_errors = 0;
+  m_lastErrors = 0;
+  m_lastRunning = 0;
+  m_lastThroughput = 0;
+
+  auto generation = m_generation;
+
+  util::Timer(5000, [this, generation](int) {
+    if (generation != m_generation || m_cancelled || !m_index->hasNext()) {
+
+      return true;
+    }
+
+    this->adjustConcurrency();
+
+    return false;
+  });
+}
+
+/*
+ * Additive increase while aggregate throughput keeps improving and
+ * multiplicative decrease when it falls or downloads fail, the configured
+ * maximum number of concurrent downloads is the ceiling.
+ */
+void downloadManager::adjustConcurrency() {
+  auto &meter = m_ctx.logger().throughput();
+
+  auto hasData = meter.hasData();
+  auto throughput = meter.total();
+  auto running = m_index->running();
+  auto errors = m_errors - m_lastErrors;
+  auto slots = m_slots;
+
+  QString reason;
+
+  if (errors > 0) {
+
+    m_slots = std::max(size_t(1), m_slots / 2);
+
+    reason = QString("%1 failed").arg(errors);
+
+  } else if (hasData && running >= m_lastRunning &&
+             throughput < m_lastThroughput * 0.9) {
+
+    // a drop caused by downloads finishing is not congestion
+    m_slots = std::max(size_t(1), m_slots / 2);
+
+    reason = "throughput fell";
+
+  } else if (running >= m_slots &&
+             (!hasData || throughput > m_lastThroughput * 1.05)) {
+
+    // without progress data the number of slots is probed upwards
+    m_slots = std::min(m_slots + 1, m_maxConcurrency);
+
+    reason = hasData ? "throughput improved" : "no progress data";
+  } else {
+    reason = "holding";
+  }
+
+  utility::locale locale;
+
+  auto speed = locale.formattedDataSize(static_cast<qint64>(throughput));
+
+  auto m = QString("Adaptive downloads: %1 -> %2 slots, %3 running, %4/s (%5)");
+
+  m_ctx.logger().add(m.arg(QString::number(slots), QString::number(m_slots),
+                           QString::number(running), speed, reason));
+
+  m_lastErrors = m_errors;
+  m_lastRunning = running;
+  m_lastThroughput = throughput;
+
+  if (m_slots > slots && m_engine) {
+
+    this->startDownloads(*m_engine, m_function);
+  }
+}
@@ -30,6 +30,11 @@
 #include <QPushButton>
 #include <QStringList>
 #include <QTableWidget>
+#include <QTimer>
+#include <QUrl>
+#include <deque>
+#include <functional>
+#include <map>
 #include <memory>
 
 class downloadManager {
@@ -85,6 +90,10 @@ public:
     utility::ProcessExitState m_exitState;
   };
 
+  /*
+   * Entries are queued per host of their url, select() picks the next entry
+   * to download and next() marks it as started.
+   */
   class index {
   public:
     index(tableWidget &t) : m_table(t) {}
@@ -94,13 +103,71 @@ public:
     bool forceDownload() const { return this->forceDownload(m_index); }
     int value() const { return this->value(m_index); }
     size_t count() const { return m_entries.size(); }
-    void next() { m_index++; }
-    bool hasNext() const {
-      return static_cast<size_t>(m_index) < m_entries.size();
+    void next() {
+      const auto &e = this->Entry(m_index);
+
+      auto &host = m_hosts[e.host];
+
+      // a selected entry is always the first one waiting on its host
+      host.waiting.pop_front();
+      host.running++;
+
+      m_runningRows[e.index] = e.host;
+      m_started++;
+    }
+    bool hasNext() const { return m_started < m_entries.size(); }
+    size_t started() const { return m_started; }
+    size_t running() const { return m_runningRows.size(); }
+    /*
+     * Selects the earliest waiting entry whose host has fewer than
+     * "maxPerHost" running downloads, 0 means hosts are not limited.
+     */
+    bool select(size_t maxPerHost) {
+      auto found = false;
+      size_t m = 0;
+
+      for (const auto &it : m_hosts) {
+
+        const auto &host = it.second;
+
+        if (host.waiting.empty()) {
+
+          continue;
+        }
+
+        if (maxPerHost == 0 || host.running < maxPerHost) {
+
+          if (!found || host.waiting.front() < m) {
+
+            m = host.waiting.front();
+            found = true;
+          }
+        }
+      }
+
+      if (found) {
+
+        m_index = static_cast<int>(m);
+      }
+
+      return found;
+    }
+    void finished(int row) {
+      auto it = m_runningRows.find(row);
+
+      if (it != m_runningRows.end()) {
+
+        m_hosts[it->second].running--;
+        m_runningRows.erase(it);
+      }
     }
     tableWidget &table() const { return m_table; }
     void add(int index, const QString &url, bool forceUpdate = false) {
-      m_entries.emplace_back(index, url, forceUpdate);
+      auto host = downloadManager::index::host(m_table.url(index));
+
+      m_hosts[host].waiting.emplace_back(m_entries.size());
+
+      m_entries.emplace_back(index, url, forceUpdate, std::move(host));
     }
     bool empty() const { return m_entries.empty(); }
     const QString &options() const { return this->options(m_index); }
@@ -118,28 +185,72 @@ public:
     }
 
   private:
+    static QString host(const QString &url) {
+      auto m = QUrl(url).host().toLower();
+
+      if (m.startsWith("www.")) {
+
+        m.remove(0, 4);
+
+      } else if (m.startsWith("m.")) {
+
+        m.remove(0, 2);
+      }
+
+      return m;
+    }
     struct entry {
-      entry(int i, const QString &o, bool s)
-          : index(i), options(o), forceDownload(s) {}
+      entry(int i, const QString &o, bool s, QString h)
+          : index(i), options(o), forceDownload(s), host(std::move(h)) {}
       int index;
       QString options;
       bool forceDownload;
+      QString host;
+    };
+    struct hostEntries {
+      std::deque<size_t> waiting;
+      size_t running = 0;
     };
     const entry &Entry(int s) const {
       return m_entries[static_cast<size_t>(s)];
     }
     int m_index = 0;
+    size_t m_started = 0;
     std::vector<entry> m_entries;
+    std::map<QString, hostEntries> m_hosts;
+    std::map<int, QString> m_runningRows;
     tableWidget &m_table;
   };
 
-  downloadManager(const Context &ctx, QPushButton &cancelButton, settings &s)
-      : m_ctx(ctx), m_cancelButton(cancelButton), m_settings(s) {}
+  /*
+   * "adaptive" is false for runs whose processes do not download media,
+   * their concurrency is never tuned to the measured throughput.
+   */
+  downloadManager(const Context &ctx, QPushButton &cancelButton, settings &s,
+                  bool adaptive = true)
+      : m_adaptable(adaptive), m_ctx(ctx), m_cancelButton(cancelButton),
+        m_settings(s) {}
   void cancelled() { m_cancelled = true; }
   template <typename Function, typename Finished>
   void monitorForFinished(const engines::engine &engine, int index,
                           utility::ProcessExitState exitState,
                           Function function, Finished finished) {
+    m_index->finished(index);
+
+    auto it = m_bandwidth.find(index);
+
+    if (it != m_bandwidth.end()) {
+
+      utility::bandwidthBudget::instance().release(it->second);
+
+      m_bandwidth.erase(it);
+    }
+
+    if (!exitState.cancelled() && !exitState.success()) {
+
+      m_errors++;
+    }
+
     if (m_cancelled) {
 
       m_cancelButton.setEnabled(false);
@@ -159,10 +270,7 @@ public:
       } else {
         finished({index, false, std::move(exitState)});
 
-        if (m_index->hasNext()) {
-
-          function(engine, m_index->value());
-        }
+        this->startDownloads(engine, function);
       }
     }
   }
@@ -179,10 +287,36 @@ public:
     m_cancelButton.setEnabled(true);
     m_index->table().setEnabled(true);
 
-    auto min = std::min(m_index->count(), maxNumberOfConcurrency);
+    m_maxConcurrency = maxNumberOfConcurrency;
+    m_maxPerHost = m_settings.maxConcurrentDownloadsPerHost();
+
+    m_engine = &engine;
+    m_function = concurrentDownload;
+
+    // stops the controller of a previous download run
+    m_generation++;
+
+    if (m_adaptable && m_settings.adaptiveConcurrentDownloads()) {
 
-    for (size_t s = 0; s < min; s++) {
-      concurrentDownload(engine, m_index->value(s));
+      this->startAdaptiveConcurrency();
+    } else {
+      m_adaptive = false;
+    }
+
+    this->startDownloads(engine, concurrentDownload);
+  }
+  bool running() const {
+    return m_index.created() && !m_cancelled && m_index->running() > 0;
+  }
+  /*
+   * Adds "row" to the entries of the current download run.
+   */
+  void append(int row, const QString &options) {
+    m_index->add(row, options);
+
+    if (m_engine) {
+
+      this->startDownloads(*m_engine, m_function);
     }
   }
   template <typename Options, typename Logger, typename TermSignal>
@@ -213,25 +347,105 @@ public:
 
     bool fd = m_index->forceDownload();
 
+    auto id = utility::concurrentID();
+
+    m_bandwidth[m_index->value()] = id;
+
+    // every slot the adaptive controller may open is reserved a share, a
+    // process that starts while few slots are open can not take the rate
+    // of the ones opened later
+    auto share = std::min(m_maxConcurrency, m_index->count());
+
+    auto rate =
+        utility::bandwidthBudget::instance().acquire(id, m_settings, share);
+
+    auto row = m_index->value();
+
     m_index->next();
 
     utility::args args(m);
 
-    utility::updateOptionsStruct opt{engine,  ep, m_settings, args,
-                                     iString, fd, {url}};
+    const auto &archiveId = m_index->table().archiveId(row);
+
+    auto infoJson = utility::infoJsonCache::fresh(archiveId, m_settings);
+
+    utility::updateOptionsStruct opt{engine, ep,    m_settings, args,    iString,
+                                     fd,     {url}, rate,       infoJson};
+
+    auto options = optsUpdater(utility::updateOptions(opt));
+
+    if (!fd && this->archived(options, row)) {
+
+      utility::bandwidthBudget::instance().release(id);
+
+      m_bandwidth.erase(row);
+
+      auto &table = m_index->table();
+
+      auto txt = engines::engine::mediaAlreadInArchiveText();
+
+      table.setUiText(table.uiText(row) + "\n" + txt, row);
+
+      // finish on the next event loop iteration to not recurse into
+      // startDownloads() once per archived entry
+      QTimer::singleShot(0, [opts = std::move(opts)]() mutable {
+        opts.done({false, 0, 0, QProcess::NormalExit});
+      });
+
+      return;
+    }
 
     auto ctx = utility::make_ctx(engine, std::move(opts), std::move(logger),
                                  std::move(terminator), channel);
 
-    utility::run(optsUpdater(utility::updateOptions(opt)), args.quality(),
-                 std::move(ctx));
+    utility::run(options, args.quality(), std::move(ctx));
   }
 
 private:
+  template <typename Function>
+  void startDownloads(const engines::engine &engine, Function &function) {
+    auto max = m_adaptive ? m_slots : m_maxConcurrency;
+
+    while (m_index->running() < max && m_index->select(m_maxPerHost)) {
+
+      if (m_adaptable && !this->bandwidthAvailable()) {
+
+        break;
+      }
+
+      auto started = m_index->started();
+
+      function(engine, m_index->value());
+
+      if (m_index->started() == started) {
+
+        // the entry was not started, stop instead of selecting it forever
+        break;
+      }
+    }
+  }
+  bool archived(QStringList &options, int row);
+  bool bandwidthAvailable();
+  void startAdaptiveConcurrency();
+  void adjustConcurrency();
   void uiEnableAll(bool e);
   size_t m_counter;
+  size_t m_maxConcurrency = 0;
+  size_t m_maxPerHost = 0;
+  bool m_adaptive = false;
+  size_t m_slots = 0;
+  bool m_waitingForBandwidth = false;
+  size_t m_errors = 0;
+  size_t m_lastErrors = 0;
+  size_t m_lastRunning = 0;
+  double m_lastThroughput = 0;
+  int m_generation = 0;
+  const engines::engine *m_engine = nullptr;
+  std::function<void(const engines::engine &, int)> m_function;
+  std::map<int, int> m_bandwidth;
   util::storage<downloadManager::index> m_index;
   bool m_cancelled;
+  bool m_adaptable;
   const Context &m_ctx;
   QPushButton &m_cancelButton;
   settings &m_settings;
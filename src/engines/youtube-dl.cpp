@@ -31,6 +31,10 @@
 
 #include "../downloadmanager.h"
 
+// prefix of progress lines that carry a json object, see
+// youtube_dl::processData
+static QString _progressMarker() { return "[download] {"; }
+
 static QJsonObject _defaultControlStructure() {
   QJsonObject obj;
 
@@ -380,7 +384,7 @@ QStringList youtube_dl::dumpJsonArguments() {
     // R"R({"url":%(url)j,"id":%(id)j,"thumbnail":%(thumbnail)j,"duration":%(duration)j,"title":%(title)j,"upload_date":%(upload_date)j,"webpage_url":%(webpage_url)j})R"
     // ;
     auto a =
-        R"R({"id":%(id)j,"thumbnail":%(thumbnail)j,"duration":%(duration)j,"title":%(title)j,"upload_date":%(upload_date)j,"webpage_url":%(webpage_url)j})R";
+        R"R({"id":%(id)j,"thumbnail":%(thumbnail)j,"duration":%(duration)j,"title":%(title)j,"upload_date":%(upload_date)j,"webpage_url":%(webpage_url)j,"url":%(url)j,"original_url":%(original_url)j,"playlist_index":%(playlist_index)j,"extractor_key":%(extractor_key)j,"ie_key":%(ie_key)j})R";
 
     return {"--no-warnings", "--newline", "--print", a};
   }
@@ -539,15 +543,136 @@ void youtube_dl::updateDownLoadCmdOptions(
     }
 
     s.ourOptions.append("--progress-template");
-    s.ourOptions.append("download:[download] %(progress._percent_str)s of "
-                        "%(progress._total_bytes_str)s at "
-                        "%(progress._speed_str)s ETA %(progress._eta_str)s");
+    s.ourOptions.append("download:" + _progressMarker() +
+                        "%(progress.{downloaded_bytes,total_bytes,"
+                        "total_bytes_estimate,speed,eta,fragment_index,"
+                        "fragment_count,filename})j");
     s.ourOptions.append("--progress-template");
     s.ourOptions.append("postprocess:" +
                         utility::stringConstants::postProcessMarker());
   }
 }
 
+static bool _progress(const QByteArray &e, Logger::Data::progress &p) {
+  util::Json json(e.mid(_progressMarker().size() - 1));
+
+  if (!json) {
+
+    return false;
+  }
+
+  auto obj = json.doc().object();
+
+  auto _number = [&obj](const char *key) {
+    auto m = obj.value(key);
+
+    return m.isDouble() ? m.toDouble() : -1;
+  };
+
+  p.downloadedBytes = static_cast<qint64>(_number("downloaded_bytes"));
+  p.totalBytes = static_cast<qint64>(_number("total_bytes"));
+  p.totalBytesIsEstimate = false;
+
+  if (p.totalBytes == -1) {
+
+    p.totalBytes = static_cast<qint64>(_number("total_bytes_estimate"));
+    p.totalBytesIsEstimate = p.totalBytes != -1;
+  }
+
+  p.speed = _number("speed");
+  p.eta = static_cast<qint64>(_number("eta"));
+  p.fragmentIndex = static_cast<int>(_number("fragment_index"));
+  p.fragmentCount = static_cast<int>(_number("fragment_count"));
+  p.fileName = obj.value("filename").toString().toUtf8();
+
+  return true;
+}
+
+void youtube_dl::processData(Logger::Data &outPut, const QByteArray &data,
+                             int id, bool readableJson) {
+  if (!data.contains(_progressMarker().toUtf8())) {
+
+    engines::engine::functions::processData(outPut, data, id, readableJson);
+
+    return;
+  }
+
+  // progress lines are stored in the data as a struct and the log gets a
+  // human readable version of it that the control structure recognizes
+  QByteArray m;
+
+  for (const auto &e : util::split(data, '\n')) {
+
+    if (!m.isEmpty()) {
+
+      m += "\n";
+    }
+
+    auto p = outPut.downloadProgress();
+
+    if (e.startsWith(_progressMarker().toUtf8()) && _progress(e.trimmed(), p)) {
+
+      outPut.setDownloadProgress(p);
+
+      m += "[download] " + youtube_dl::progressText(p);
+    } else {
+      m += e;
+    }
+  }
+
+  engines::engine::functions::processData(outPut, m, id, readableJson);
+}
+
+QByteArray youtube_dl::progressText(const Logger::Data::progress &p) {
+  utility::locale locale;
+
+  auto _size = [&locale](qint64 s) {
+    return locale.formattedDataSize(s).toUtf8();
+  };
+
+  QByteArray m;
+
+  if (p.totalBytes > 0) {
+
+    auto percent = 100.0 * static_cast<double>(p.downloadedBytes) /
+                   static_cast<double>(p.totalBytes);
+
+    m = QByteArray::number(percent, 'f', 1) + "% of ";
+
+    if (p.totalBytesIsEstimate) {
+
+      m += "~";
+    }
+
+    m += _size(p.totalBytes);
+  } else {
+    m = _size(p.downloadedBytes);
+  }
+
+  if (p.speed >= 0) {
+
+    m += " at " + _size(static_cast<qint64>(p.speed)) + "/s";
+  }
+
+  if (p.eta >= 0) {
+
+    auto e = engines::engine::functions::timer::duration(
+        static_cast<int>(p.eta * 1000));
+
+    m += " ETA " + e.toUtf8();
+  } else {
+    m += " ETA Unknown";
+  }
+
+  if (p.fragmentIndex != -1 && p.fragmentCount != -1) {
+
+    m += " (frag " + QByteArray::number(p.fragmentIndex) + "/" +
+         QByteArray::number(p.fragmentCount) + ")";
+  }
+
+  return m;
+}
+
 youtube_dl::youtube_dlFilter::youtube_dlFilter(const QString &e,
                                                const engines::engine &engine)
     : engines::engine::functions::filter(e, engine),
@@ -565,41 +690,85 @@ youtube_dl::youtube_dlFilter::operator()(const Logger::Data &s) {
 
 youtube_dl::youtube_dlFilter::~youtube_dlFilter() {}
 
-const QByteArray &
-youtube_dl::youtube_dlFilter::youtubedlOutput(const Logger::Data &s) {
-  const auto data = s.toStringList();
+bool youtube_dl::youtube_dlFilter::parseLine(const QByteArray &e) {
+  if (e.startsWith("ERROR: ") ||
+      (m_likeYtdlp && e.startsWith("core: error:"))) {
 
-  for (const auto &e : data) {
+    m_result = e;
+    return true;
+  }
+  if (e.startsWith("[download] ") &&
+      e.contains(" has already been downloaded")) {
 
-    if (e.startsWith("ERROR: ")) {
+    m_fileName = e.mid(e.indexOf(" ") + 1);
+    m_fileName.truncate(m_fileName.indexOf(" has already been downloaded"));
+    m_result = m_fileName;
+    return true;
+  }
+  if (e.contains("] Destination: ")) {
 
-      m_tmp = e;
-      return m_tmp;
-    }
-    if (e.startsWith("[download] ") &&
-        e.contains(" has already been downloaded")) {
+    m_fileName = e.mid(e.indexOf("] Destination: ") + 15);
+  }
+  if (e.contains(" Merging formats into \"")) {
 
-      m_fileName = e.mid(e.indexOf(" ") + 1);
-      m_fileName.truncate(m_fileName.indexOf(" has already been downloaded"));
-      return m_fileName;
-    }
-    if (e.contains("] Destination: ")) {
+    m_fileName = e.mid(e.indexOf("\"") + 1);
+    m_fileName.truncate(m_fileName.size() - 1);
+  }
+  if (e.contains("has already been recorded in archive")) {
 
-      m_fileName = e.mid(e.indexOf("] Destination: ") + 15);
-    }
-    if (e.contains(" Merging formats into \"")) {
+    m_result = engines::engine::mediaAlreadInArchiveText().toUtf8();
 
-      m_fileName = e.mid(e.indexOf("\"") + 1);
-      m_fileName.truncate(m_fileName.size() - 1);
-    }
-    if (e.contains("has already been recorded in archive")) {
+    return true;
+  }
 
-      m_tmp = engines::engine::mediaAlreadInArchiveText().toUtf8();
+  return false;
+}
 
-      return m_tmp;
+bool youtube_dl::youtube_dlFilter::parseNewLines(const Logger::Data &s) {
+  // positions count every line ever added, the data may have dropped
+  // older ones
+  auto first = s.evicted();
+  auto end = first + s.size();
+
+  if (end < m_position) {
+
+    // the data was cleared
+    m_position = 0;
+    m_hasResult = false;
+  }
+
+  if (m_hasResult) {
+
+    return true;
+  }
+
+  // lines before the last one do not change once added, the last one is
+  // looked at again because progress lines are replaced in place
+  for (auto i = std::max(m_position, first); i < end; i++) {
+
+    for (const auto &e : util::split(s[i - first], '\n')) {
+
+      if (this->parseLine(e)) {
+
+        m_hasResult = true;
+
+        return true;
+      }
     }
   }
 
+  m_position = end > first ? end - 1 : first;
+
+  return false;
+}
+
+const QByteArray &
+youtube_dl::youtube_dlFilter::youtubedlOutput(const Logger::Data &s) {
+  if (this->parseNewLines(s)) {
+
+    return m_result;
+  }
+
   if (s.lastLineIsProgressLine()) {
 
     const auto &mm = s.lastText();
@@ -634,40 +803,23 @@ youtube_dl::youtube_dlFilter::youtubedlOutput(const Logger::Data &s) {
 
 const QByteArray &
 youtube_dl::youtube_dlFilter::ytdlpOutput(const Logger::Data &s) {
-  const auto data = s.toStringList();
+  if (this->parseNewLines(s)) {
 
-  for (const auto &e : data) {
+    return m_result;
+  }
 
-    if (e.startsWith("ERROR: ") || e.startsWith("core: error:")) {
+  if (s.lastLineIsProgressLine()) {
 
-      m_tmp = e;
-      return m_tmp;
-    }
-    if (e.startsWith("[download] ") &&
-        e.contains(" has already been downloaded")) {
+    const auto &p = s.downloadProgress();
 
-      m_fileName = e.mid(e.indexOf(" ") + 1);
-      m_fileName.truncate(m_fileName.indexOf(" has already been downloaded"));
-      return m_fileName;
-    }
-    if (e.contains("] Destination: ")) {
+    if (p.isSet()) {
 
-      m_fileName = e.mid(e.indexOf("] Destination: ") + 15);
-    }
-    if (e.contains(" Merging formats into \"")) {
-
-      m_fileName = e.mid(e.indexOf("\"") + 1);
-      m_fileName.truncate(m_fileName.size() - 1);
-    }
-    if (e.contains("has already been recorded in archive")) {
+      const auto &name = m_fileName.isEmpty() ? p.fileName : m_fileName;
 
-      m_tmp = engines::engine::mediaAlreadInArchiveText().toUtf8();
+      m_tmp = name + "\n" + youtube_dl::progressText(p);
 
       return m_tmp;
     }
-  }
-
-  if (s.lastLineIsProgressLine()) {
 
     const auto &mm = s.lastText();
 
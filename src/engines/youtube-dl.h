@@ -41,11 +41,16 @@ public:
 	private:
 		const QByteArray& youtubedlOutput( const Logger::Data& ) ;
 		const QByteArray& ytdlpOutput( const Logger::Data& ) ;
+		bool parseNewLines( const Logger::Data& ) ;
+		bool parseLine( const QByteArray& ) ;
 		bool m_likeYtdlp ;
 		engines::engine::functions::preProcessing m_preProcessing ;
 		engines::engine::functions::postProcessing m_postProcessing ;
 		QByteArray m_tmp ;
 		QByteArray m_fileName ;
+		QByteArray m_result ;
+		bool m_hasResult = false ;
+		size_t m_position = 0 ;
 	} ;
 
 	std::vector< QStringList > mediaProperties( const QByteArray& ) override ;
@@ -65,6 +70,12 @@ public:
 
 	void updateDownLoadCmdOptions( const engines::engine::functions::updateOpts& ) override ;
 
+	using engines::engine::functions::processData ;
+
+	void processData( Logger::Data&,const QByteArray&,int id,bool readableJson ) override ;
+
+	static QByteArray progressText( const Logger::Data::progress& ) ;
+
 	static QJsonObject init( const QString& name,
 				 const QString& configFileName,
 				 Logger& logger,
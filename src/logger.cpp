@@ -27,8 +27,14 @@
 #include "utility.h"
 
 Logger::Logger(QPlainTextEdit &e, QWidget *, settings &s)
-    : m_logWindow(nullptr, s, *this), m_textEdit(e) {
+    : m_logWindow(nullptr, s, *this), m_progressUpdates(s),
+      m_maxLines(s.logMaxLines()), m_maxBytes(s.logMaxSize() * 1024),
+      m_textEdit(e) {
   m_textEdit.setReadOnly(true);
+  m_textEdit.setUndoRedoEnabled(false);
+
+  m_lines.setLimits(m_maxLines, m_maxBytes,
+                    [this](const QByteArray &m) { this->spill(m); });
 }
 
 void Logger::add(const QByteArray &s, int id) {
@@ -43,46 +49,305 @@ void Logger::add(const QByteArray &s, int id) {
 }
 
 void Logger::clear() {
+  m_progressUpdates.cancel(-1);
   m_lines.clear();
+  m_lines.flushChanges([](bool, int, int, const QByteArray &) {});
+
+  if (m_spillFile.isOpen()) {
+
+    m_spillFile.resize(0);
+    m_spillFile.seek(0);
+  }
+
   m_textEdit.clear();
   m_logWindow.clear();
+  m_textEditIsStale = false;
+  m_authenticationError = false;
 }
 
 void Logger::showLogWindow() {
-  m_logWindow.setText(m_lines.toString());
+  // pending changes must land before the window is given the full text or
+  // they would be appended to it a second time
+  this->flush();
+  m_logWindow.setText(this->text());
   m_logWindow.Show();
 }
 
 void Logger::updateView(bool e) {
+  this->flush();
+
   m_updateView = e;
+
+  if (m_updateView && m_textEditIsStale) {
+
+    m_textEditIsStale = false;
+
+    m_textEdit.setPlainText(this->text());
+    m_textEdit.moveCursor(QTextCursor::End);
+  }
+
   this->update();
 }
 
+static bool _authenticationError(const QByteArray &m) {
+  return m.contains("Sign in to confirm") ||
+         m.contains("User is not entitled") ||
+         m.contains("Authentication required") ||
+         m.contains("LogIn to access") || m.contains("access denied") ||
+         m.contains("Unauthorized");
+}
+
+static QByteArray _authenticationErrorText() {
+  return "ERROR: Unable to download without authentication.\n\nSign-In to "
+         "the website with an account from built-in browser or provide "
+         "authentication cookie in \"Settings section\" and try again.";
+}
+
+QByteArray Logger::text() const {
+  if (m_authenticationError) {
+
+    return _authenticationErrorText();
+  }
+
+  QByteArray m;
+
+  m_lines.forEach([&m](int, const QByteArray &e) {
+    if (!m.isEmpty()) {
+
+      m += "\n";
+    }
+
+    m += Logger::Data::displayText(e);
+  });
+
+  return m;
+}
+
 void Logger::update() {
-  auto m = m_lines.toString();
+  m_progressUpdates.post(-1, [this]() { this->updateViews(); });
+}
 
-  m = m.replace(
-      "Confirm you are on the latest version using  yt-dlp -U",
-      "\n\nConfirm you are on the latest version, Go to Settings and click "
-      "\"Update Engine\"");
+void Logger::updateViews() {
+  m_lines.flushChanges([this](bool reset, int evictedBlocks, int removedBlocks,
+                              const QByteArray &text) {
+    if (m_authenticationError) {
+
+      return;
+    }
+
+    // only newly changed lines are scanned, once found the error message
+    // replaces the whole log until it is cleared
+    if (_authenticationError(text)) {
+
+      m_authenticationError = true;
+
+      auto m = _authenticationErrorText();
 
-  // authentication error
-  if (m.contains("Sign in to confirm") || m.contains("User is not entitled") ||
-      m.contains("Authentication required") || m.contains("LogIn to access") ||
-      m.contains("access denied") ||
-      m.contains("401 Unauthorized" || m.contains("Unauthorized"))) {
-    m = "ERROR: Unable to download without authentication.\n\nSign-In to the "
-        "website with an account from built-in browser or provide "
-        "authentication cookie in \"Settings section\" and try again.";
+      if (m_updateView) {
+
+        m_textEdit.setPlainText(m);
+        m_textEdit.moveCursor(QTextCursor::End);
+      } else {
+        m_textEditIsStale = true;
+      }
+
+      m_logWindow.update(m);
+
+      return;
+    }
+
+    if (m_updateView) {
+
+      if (reset) {
+
+        m_textEdit.setPlainText(text);
+        m_textEdit.moveCursor(QTextCursor::End);
+      } else {
+        logWindow::removeFirstBlocks(m_textEdit, evictedBlocks);
+        logWindow::replaceLastBlocks(m_textEdit, removedBlocks, text);
+      }
+    } else {
+      m_textEditIsStale = true;
+    }
+
+    if (m_logWindow.update(reset, evictedBlocks, removedBlocks, text)) {
+
+      // also forgets the position of the older lines it loaded
+      m_logWindow.setText(this->text());
+    }
+  });
+}
+
+Logger::progressCoalescer::progressCoalescer(settings &s) {
+  auto rate = s.progressUpdateRate();
+
+  m_interval = rate > 0 ? 1000 / rate : 0;
+
+  m_timer.setSingleShot(true);
+
+  QObject::connect(&m_timer, &QTimer::timeout, [this]() { this->tick(); });
+}
+
+void Logger::progressCoalescer::post(int id, std::function<void()> function) {
+  if (m_interval == 0) {
+
+    function();
+  } else {
+    m_pending[id] = std::move(function);
+
+    if (!m_timer.isActive()) {
+
+      m_timer.start(m_interval);
+    }
   }
+}
 
-  if (m_updateView) {
+void Logger::progressCoalescer::cancel(int id) { m_pending.erase(id); }
 
-    m_textEdit.setPlainText(m);
-    m_textEdit.moveCursor(QTextCursor::End);
+void Logger::progressCoalescer::flush(int id) {
+  auto it = m_pending.find(id);
+
+  if (it != m_pending.end()) {
+
+    auto function = std::move(it->second);
+
+    m_pending.erase(it);
+
+    function();
   }
+}
+
+void Logger::progressCoalescer::tick() {
+  // updates may post again while running, they go to the next tick
+  auto m = std::move(m_pending);
+
+  m_pending.clear();
+
+  for (auto &it : m) {
+
+    it.second();
+  }
+}
+
+Logger::throughputMeter::throughputMeter() { m_timer.start(); }
+
+void Logger::throughputMeter::update(int id, double bytesPerSecond) {
+  m_entries[id] = {bytesPerSecond, m_timer.elapsed()};
+}
+
+bool Logger::throughputMeter::hasData() {
+  this->removeStale();
+
+  return !m_entries.empty();
+}
+
+double Logger::throughputMeter::total() {
+  this->removeStale();
+
+  double m = 0;
+
+  for (const auto &it : m_entries) {
+
+    m += it.second.speed;
+  }
+
+  return m;
+}
+
+void Logger::throughputMeter::removeStale() {
+  auto now = m_timer.elapsed();
+
+  for (auto it = m_entries.begin(); it != m_entries.end();) {
+
+    if (now - it->second.time > 3000) {
+
+      it = m_entries.erase(it);
+    } else {
+      it++;
+    }
+  }
+}
+
+void Logger::spill(const QByteArray &e) {
+  if (!m_spillFile.isOpen() && !m_spillFile.open()) {
+
+    return;
+  }
+
+  m_spillFile.write(Logger::Data::displayText(e) + "\n");
+}
+
+QByteArray Logger::spilledText(qint64 &position, qint64 size) {
+  if (!m_spillFile.isOpen()) {
+
+    position = 0;
+
+    return {};
+  }
+
+  m_spillFile.flush();
+
+  auto end = m_spillFile.size();
+
+  if (position < 0 || position > end) {
+
+    position = end;
+  }
+
+  auto start = position - size > 0 ? position - size : 0;
+
+  m_spillFile.seek(start);
+
+  auto m = m_spillFile.read(position - start);
+
+  // lines dropped later are appended
+  m_spillFile.seek(end);
+
+  if (start > 0) {
+
+    // the first line is only partly read unless it is all there is
+    auto s = m.indexOf('\n');
+
+    if (s != -1 && s + 1 < m.size()) {
+
+      m = m.mid(s + 1);
+      start += s + 1;
+    }
+  }
+
+  position = start;
+
+  if (m.endsWith('\n')) {
+
+    m.chop(1);
+  }
+
+  return m;
+}
+
+static const char *_updateEngineText() {
+  return "Confirm you are on the latest version using  yt-dlp -U";
+}
+
+QByteArray Logger::Data::displayText(const QByteArray &e) {
+  auto m = e;
+
+  if (m.contains('\r')) {
+
+    // QTextDocument treats a lone carriage return as a block separator and
+    // that would throw off block counting of incremental view updates
+    m.replace('\r', "");
+  }
+
+  return m.replace(
+      _updateEngineText(),
+      "\n\nConfirm you are on the latest version, Go to Settings and click "
+      "\"Update Engine\"");
+}
 
-  m_logWindow.update(m);
+int Logger::Data::blockCount(const QByteArray &e) {
+  // same as displayText( e ).count( '\n' ) + 1 without making a copy
+  return e.count('\n') + 2 * e.count(_updateEngineText()) + 1;
 }
 
 QList<QByteArray> Logger::Data::toStringList() const {
@@ -28,6 +28,16 @@
 #include <QStringList>
 #include <QTableWidgetItem>
 #include <QDebug>
+#include <QTimer>
+#include <QTemporaryFile>
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <unordered_map>
 
 #include "logwindow.h"
 #include "util.hpp"
@@ -35,12 +45,83 @@
 class Logger
 {
 public:
+	/*
+	 * Holds the latest pending ui update of each download and runs them all
+	 * together on a single timer tick.
+	 *
+	 * A download posts its update under its id and a newer post replaces an older
+	 * one so intermediate progress lines are never shown. Id -1 is used by the
+	 * Logger for its own text views.
+	 */
+	class progressCoalescer
+	{
+	public:
+		progressCoalescer( settings& ) ;
+		void post( int id,std::function< void() > ) ;
+		void cancel( int id ) ;
+		void flush( int id ) ;
+	private:
+		void tick() ;
+		QTimer m_timer ;
+		int m_interval ;
+		std::map< int,std::function< void() > > m_pending ;
+	} ;
+
+	/*
+	 * Latest download speed of each running download by logger id, a speed
+	 * that was not updated for a few seconds no longer counts.
+	 */
+	class throughputMeter
+	{
+	public:
+		throughputMeter() ;
+		void update( int id,double bytesPerSecond ) ;
+		bool hasData() ;
+		double total() ;
+	private:
+		void removeStale() ;
+		struct entry
+		{
+			double speed ;
+			qint64 time ;
+		} ;
+		QElapsedTimer m_timer ;
+		std::map< int,entry > m_entries ;
+	} ;
+
 	class Data
 	{
 	public:
+		/*
+		 * Latest progress of a download as reported by an engine that
+		 * supports machine readable progress, fields it did not report are -1.
+		 */
+		struct progress
+		{
+			bool isSet() const
+			{
+				return downloadedBytes != -1 ;
+			}
+			qint64 downloadedBytes = -1 ;
+			qint64 totalBytes = -1 ;
+			bool totalBytesIsEstimate = false ;
+			double speed = -1 ;
+			qint64 eta = -1 ;
+			int fragmentIndex = -1 ;
+			int fragmentCount = -1 ;
+			QByteArray fileName ;
+		} ;
+		const Logger::Data::progress& downloadProgress() const
+		{
+			return m_progress ;
+		}
+		void setDownloadProgress( Logger::Data::progress p )
+		{
+			m_progress = std::move( p ) ;
+		}
 		bool isEmpty() const
 		{
-			return m_lines.empty() ;
+			return m_size == 0 ;
 		}
 		bool isNotEmpty() const
 		{
@@ -48,27 +129,40 @@ public:
 		}
 		size_t size() const
 		{
-			return m_lines.size() ;
+			return m_size ;
 		}
 		const QByteArray& operator[]( size_t s ) const
 		{
-			return m_lines[ s ].text() ;
+			for( const auto& it : m_segments ){
+
+				if( s < it.lines.size() ){
+
+					return it.lines[ s ].text() ;
+				}else{
+					s -= it.lines.size() ;
+				}
+			}
+
+			return this->lastText() ;
 		}
 		template< typename Function >
 		void forEach( Function function ) const
 		{
-			for( const auto& it : m_lines ){
+			for( const auto& it : m_segments ){
+
+				for( const auto& xt : it.lines ){
 
-				function( it.id(),it.text() ) ;
+					function( xt.id(),xt.text() ) ;
+				}
 			}
 		}
 		const QByteArray& lastText() const
 		{
-			return m_lines[ m_lines.size() - 1 ].text() ;
+			return m_segments.back().lines.back().text() ;
 		}
 		bool lastLineIsProgressLine() const
 		{
-			return m_lines[ m_lines.size() - 1 ].progressLine() ;
+			return m_segments.back().lines.back().progressLine() ;
 		}
 		bool doneDownloading() const
 		{
@@ -76,58 +170,145 @@ public:
 		}
 		void clear()
 		{
-			m_lines.clear() ;
+			m_segments.clear() ;
+			m_index.clear() ;
+			m_progress = {} ;
+			m_firstSegment = 0 ;
+			m_size = 0 ;
+			m_evicted = 0 ;
+			m_bytes = 0 ;
+
+			m_dirty = { 0,0 } ;
+			m_removedBlocks = 0 ;
+			m_evictedBlocks = 0 ;
+			m_reset = true ;
 		}
+		/*
+		 * Keeps at most "maxLines" lines and "maxBytes" bytes of text by
+		 * dropping the oldest lines, the last line is always kept. 0 means no limit.
+		 *
+		 * Dropped lines are handed to "spill" if it is set.
+		 */
+		void setLimits( size_t maxLines,size_t maxBytes,std::function< void( const QByteArray& ) > spill = {} )
+		{
+			m_maxLines = maxLines ;
+			m_maxBytes = maxBytes ;
+			m_spill = std::move( spill ) ;
 
-		QList< QByteArray > toStringList() const ;
-
-		QByteArray toString() const
+			this->evict() ;
+		}
+		/*
+		 * Number of lines dropped from the front since the data was last cleared,
+		 * operator[]( 0 ) is line number evicted() of everything ever added.
+		 */
+		size_t evicted() const
 		{
-			if( this->isNotEmpty() ){
+			return m_evicted ;
+		}
+		/*
+		 * Hands over lines that changed since the last call as a delta for
+		 * the text views.
+		 *
+		 * "evictedBlocks" is the number of text blocks at the start of a view
+		 * whose lines were dropped, "removedBlocks" is the number of text blocks
+		 * at the end of a view that are now stale and "text" is what must be
+		 * appended in their place. "reset" is set when the view must be rebuilt
+		 * from "text" alone.
+		 */
+		template< typename Function >
+		void flushChanges( Function function )
+		{
+			auto end = this->endPosition() ;
 
-				auto it = m_lines.begin() ;
+			if( m_reset || m_removedBlocks > 0 || m_evictedBlocks > 0 || m_dirty < end ){
 
-				auto m = it->text() ;
+				QByteArray text ;
 
-				it++ ;
+				auto first = true ;
 
-				for( ; it != m_lines.end() ; it++ ){
+				this->forEachFrom( m_dirty,[ & ]( const Logger::Data::line& e ){
 
-					m += "\n" + it->text() ;
-				}
+					if( first ){
 
-				return m ;
-			}else{
-				return {} ;
+						first = false ;
+					}else{
+						text += "\n" ;
+					}
+
+					text += Logger::Data::displayText( e.text() ) ;
+				} ) ;
+
+				auto reset = m_reset ;
+				auto evictedBlocks = m_evictedBlocks ;
+				auto removedBlocks = m_removedBlocks ;
+
+				m_dirty = end ;
+				m_evictedBlocks = 0 ;
+				m_removedBlocks = 0 ;
+				m_reset = false ;
+
+				function( reset,evictedBlocks,removedBlocks,text ) ;
 			}
 		}
-		QByteArray toLine() const
-		{
-			if( this->isNotEmpty() ){
+		static QByteArray displayText( const QByteArray& ) ;
 
-				auto it = m_lines.begin() ;
+		QList< QByteArray > toStringList() const ;
 
-				auto m = it->text() ;
+		QByteArray toString() const
+		{
+			QByteArray m ;
 
-				it++ ;
+			this->forEach( [ & ]( int,const QByteArray& e ){
 
-				for( ; it != m_lines.end() ; it++ ){
+				if( !m.isEmpty() ){
 
-					m += it->text() ;
+					m += "\n" ;
 				}
 
-				return m ;
-			}else{
-				return {} ;
-			}
+				m += e ;
+			} ) ;
+
+			return m ;
+		}
+		QByteArray toLine() const
+		{
+			QByteArray m ;
+
+			this->forEach( [ & ]( int,const QByteArray& e ){
+
+				m += e ;
+			} ) ;
+
+			return m ;
 		}
 		void removeLast()
 		{
-			m_lines.pop_back() ;
+			auto number = m_firstSegment + m_segments.size() - 1 ;
+
+			auto& s = m_segments.back() ;
+
+			this->markDirty( { number,s.lines.size() - 1 } ) ;
+
+			m_bytes -= static_cast< size_t >( s.lines.back().text().size() ) ;
+			s.blocks -= s.lines.back().blocks() ;
+
+			s.lines.pop_back() ;
+			m_size-- ;
+
+			if( s.lines.empty() ){
+
+				this->unindex( s.id,number ) ;
+
+				m_segments.pop_back() ;
+			}
 		}
 		void replaceLast( const QByteArray& e )
 		{
-			m_lines.rbegin()->replace( e ) ;
+			auto number = m_firstSegment + m_segments.size() - 1 ;
+
+			this->replace( number,e ) ;
+
+			this->evict() ;
 		}
 		template< typename Function,typename Add >
 		void replaceOrAdd( const QByteArray& text,int id,Function function,Add add )
@@ -143,6 +324,75 @@ public:
 	private:
 		bool postProcessText( const QByteArray& data ) ;
 
+		class line
+		{
+		public:
+			line( const QByteArray& text,int id,bool p = false ) :
+				m_text( text ),
+				m_id( id ),
+				m_progressLine( p ),
+				m_blocks( Logger::Data::blockCount( text ) )
+			{
+			}
+			const QByteArray& text() const
+			{
+				return m_text ;
+			}
+			bool progressLine() const
+			{
+				return m_progressLine ;
+			}
+			int id() const
+			{
+				return m_id ;
+			}
+			int blocks() const
+			{
+				return m_blocks ;
+			}
+			void replace( const QByteArray& text )
+			{
+				m_progressLine = true ;
+				m_text = text ;
+				m_blocks = Logger::Data::blockCount( text ) ;
+			}
+		private:
+			QByteArray m_text ;
+			int m_id ;
+			bool m_progressLine ;
+			int m_blocks ;
+		} ;
+		/*
+		 * Lines of a download are kept together in one segment and segments
+		 * are kept in the order they were created, this is also the display
+		 * order. Consecutive lines without an id share a segment.
+		 *
+		 * Segments are numbered and the first one is number m_firstSegment,
+		 * numbers do not change when older segments are dropped.
+		 */
+		struct segment
+		{
+			segment( int i ) : id( i )
+			{
+			}
+			int id ;
+			int blocks = 0 ;
+			std::deque< Logger::Data::line > lines ;
+		} ;
+		struct position
+		{
+			size_t segment ;
+			size_t line ;
+			bool operator<( const position& other ) const
+			{
+				if( segment == other.segment ){
+
+					return line < other.line ;
+				}else{
+					return segment < other.segment ;
+				}
+			}
+		} ;
 		template< typename Function,typename Add >
 		void _replaceOrAdd( const QByteArray& text,int id,Function function,Add add )
 		{
@@ -155,77 +405,244 @@ public:
 
 			if( id != -1 ){
 
-				for( auto it = m_lines.rbegin() ; it != m_lines.rend() ; it++ ){
+				auto it = m_index.find( id ) ;
 
-					if( it->id() == id ){
+				if( it != m_index.end() ){
 
-						if( function( it->text() ) ){
+					auto number = it->second ;
 
-							if( add( it->text() ) ){
+					const auto& last = this->segmentAt( number ).lines.back().text() ;
 
-								this->add( it,text,id ) ;
-							}else{
-								it->replace( text ) ;
-							}
-						}else{
-							this->add( it,text,id ) ;
-						}
+					if( function( last ) && !add( last ) ){
 
-						return ;
+						this->replace( number,text ) ;
+					}else{
+						this->append( number,text,id ) ;
 					}
+
+					this->evict() ;
+
+					return ;
 				}
 			}
 
-			m_lines.emplace_back( text,id ) ;
+			if( id == -1 && !m_segments.empty() && m_segments.back().id == -1 ){
+
+				this->append( m_firstSegment + m_segments.size() - 1,text,id ) ;
+			}else{
+				auto number = m_firstSegment + m_segments.size() ;
+
+				m_segments.emplace_back( id ) ;
+
+				if( id != -1 ){
+
+					m_index[ id ] = number ;
+				}
+
+				this->append( number,text,id ) ;
+			}
+
+			this->evict() ;
+		}
+		Logger::Data::segment& segmentAt( size_t number )
+		{
+			return m_segments[ number - m_firstSegment ] ;
+		}
+		const Logger::Data::segment& segmentAt( size_t number ) const
+		{
+			return m_segments[ number - m_firstSegment ] ;
 		}
-		template< typename It >
-		void add( const It& it,const QByteArray& text,int id )
+		void append( size_t number,const QByteArray& text,int id )
 		{
-			if( it != m_lines.rbegin() ){
+			auto& s = this->segmentAt( number ) ;
 
-				m_lines.emplace( it.base(),text,id ) ;
-			}else{
-				m_lines.emplace_back( text,id ) ;
+			this->markDirty( { number,s.lines.size() } ) ;
+
+			s.lines.emplace_back( text,id ) ;
+			s.blocks += s.lines.back().blocks() ;
+
+			m_bytes += static_cast< size_t >( text.size() ) ;
+			m_size++ ;
+		}
+		void replace( size_t number,const QByteArray& text )
+		{
+			auto& s = this->segmentAt( number ) ;
+
+			this->markDirty( { number,s.lines.size() - 1 } ) ;
+
+			auto& e = s.lines.back() ;
+
+			m_bytes -= static_cast< size_t >( e.text().size() ) ;
+			m_bytes += static_cast< size_t >( text.size() ) ;
+
+			s.blocks -= e.blocks() ;
+
+			e.replace( text ) ;
+
+			s.blocks += e.blocks() ;
+		}
+		void unindex( int id,size_t number )
+		{
+			if( id != -1 ){
+
+				auto it = m_index.find( id ) ;
+
+				if( it != m_index.end() && it->second == number ){
+
+					m_index.erase( it ) ;
+				}
 			}
 		}
-		class line
+		Logger::Data::position endPosition() const
 		{
-		public:
-			line( const QByteArray& text,int id,bool p = false ) :
-				m_text( text ),
-				m_id( id ),
-				m_progressLine( p )
-			{
+			if( m_segments.empty() ){
+
+				return { m_firstSegment,0 } ;
+			}else{
+				return { m_firstSegment + m_segments.size() - 1,m_segments.back().lines.size() } ;
 			}
-			line( const QByteArray& text ) :
-				m_text( text ),
-				m_id( -1 )
-			{
+		}
+		template< typename Function >
+		void forEachFrom( Logger::Data::position p,Function function ) const
+		{
+			auto end = m_firstSegment + m_segments.size() ;
+
+			for( auto n = std::max( p.segment,m_firstSegment ) ; n < end ; n++ ){
+
+				const auto& lines = this->segmentAt( n ).lines ;
+
+				for( auto s = n == p.segment ? p.line : 0 ; s < lines.size() ; s++ ){
+
+					function( lines[ s ] ) ;
+				}
 			}
-			const QByteArray& text() const
-			{
-				return m_text ;
+		}
+		/*
+		 * Number of text blocks taken by lines in [ from,to ).
+		 */
+		int blocks( Logger::Data::position from,Logger::Data::position to ) const
+		{
+			int m = 0 ;
+
+			auto end = m_firstSegment + m_segments.size() ;
+
+			for( auto n = from.segment ; n <= to.segment && n < end ; n++ ){
+
+				const auto& s = this->segmentAt( n ) ;
+
+				auto a = n == from.segment ? from.line : 0 ;
+				auto b = n == to.segment ? std::min( to.line,s.lines.size() ) : s.lines.size() ;
+
+				if( b - a <= s.lines.size() - ( b - a ) ){
+
+					for( auto i = a ; i < b ; i++ ){
+
+						m += s.lines[ i ].blocks() ;
+					}
+				}else{
+					// fewer lines are outside the range than inside it
+					m += s.blocks ;
+
+					for( size_t i = 0 ; i < a ; i++ ){
+
+						m -= s.lines[ i ].blocks() ;
+					}
+
+					for( auto i = b ; i < s.lines.size() ; i++ ){
+
+						m -= s.lines[ i ].blocks() ;
+					}
+				}
 			}
-			bool progressLine() const
-			{
-				return m_progressLine ;
+
+			return m ;
+		}
+		void markDirty( Logger::Data::position p )
+		{
+			/*
+			 * Lines before m_dirty are what the views currently show,
+			 * a change before it makes the views drop everything from that
+			 * line onwards.
+			 */
+			if( p < m_dirty ){
+
+				m_removedBlocks += this->blocks( p,m_dirty ) ;
+
+				m_dirty = p ;
 			}
-			int id() const
-			{
-				return m_id ;
+		}
+		static int blockCount( const QByteArray& ) ;
+		bool overLimit() const
+		{
+			if( m_maxLines > 0 && m_size > m_maxLines ){
+
+				return true ;
+			}else{
+				return m_maxBytes > 0 && m_bytes > m_maxBytes ;
 			}
-			void replace( const QByteArray& text )
-			{
-				m_progressLine = true ;
-				m_text = text ;
+		}
+		void evict()
+		{
+			while( m_size > 1 && this->overLimit() ){
+
+				auto& s = m_segments.front() ;
+
+				const auto& e = s.lines.front() ;
+
+				if( position{ m_firstSegment,0 } < m_dirty ){
+
+					// the line is shown in the views
+					m_evictedBlocks += e.blocks() ;
+
+					if( m_dirty.segment == m_firstSegment ){
+
+						m_dirty.line-- ;
+					}
+				}
+
+				if( m_spill ){
+
+					m_spill( e.text() ) ;
+				}
+
+				m_bytes -= static_cast< size_t >( e.text().size() ) ;
+				s.blocks -= e.blocks() ;
+
+				s.lines.pop_front() ;
+
+				m_size-- ;
+				m_evicted++ ;
+
+				if( s.lines.empty() ){
+
+					this->unindex( s.id,m_firstSegment ) ;
+
+					m_segments.pop_front() ;
+
+					if( m_dirty.segment == m_firstSegment ){
+
+						m_dirty = { m_firstSegment + 1,0 } ;
+					}
+
+					m_firstSegment++ ;
+				}
 			}
-		private:
-			QByteArray m_text ;
-			int m_id ;
-			bool m_progressLine ;
-		} ;
-		std::vector< Logger::Data::line > m_lines ;
+		}
+		std::deque< Logger::Data::segment > m_segments ;
+		std::unordered_map< int,size_t > m_index ;
+		Logger::Data::progress m_progress ;
+		std::function< void( const QByteArray& ) > m_spill ;
+		size_t m_firstSegment = 0 ;
+		size_t m_size = 0 ;
+		size_t m_maxLines = 0 ;
+		size_t m_maxBytes = 0 ;
+		size_t m_bytes = 0 ;
+		size_t m_evicted = 0 ;
 		bool m_doneDownloading = false ;
+		Logger::Data::position m_dirty = { 0,0 } ;
+		int m_removedBlocks = 0 ;
+		int m_evictedBlocks = 0 ;
+		bool m_reset = false ;
 	} ;
 
 	Logger( QPlainTextEdit&,QWidget * parent,settings& ) ;
@@ -252,6 +669,32 @@ public:
 	}
 	void showLogWindow() ;
 	void updateView( bool e ) ;
+	void flush()
+	{
+		m_progressUpdates.flush( -1 ) ;
+	}
+	Logger::progressCoalescer& progressUpdates()
+	{
+		return m_progressUpdates ;
+	}
+	Logger::throughputMeter& throughput()
+	{
+		return m_throughput ;
+	}
+	/*
+	 * Applies the configured log size limits to a download's own data,
+	 * dropped lines are handed to "spill" if it is set.
+	 */
+	void limit( Logger::Data& e,std::function< void( const QByteArray& ) > spill = {} ) const
+	{
+		e.setLimits( m_maxLines,m_maxBytes,std::move( spill ) ) ;
+	}
+	/*
+	 * Returns up to "size" bytes of whole lines that were dropped from the log
+	 * and come just before file offset "position", -1 means after the last one.
+	 * "position" is updated to where the returned text starts.
+	 */
+	QByteArray spilledText( qint64& position,qint64 size ) ;
 	Logger( const Logger& ) = delete ;
 	Logger& operator=( const Logger& ) = delete ;
 	Logger( Logger&& ) = delete ;
@@ -297,10 +740,20 @@ public:
 	};
 private:
 	void update() ;
+	void updateViews() ;
+	void spill( const QByteArray& ) ;
+	QByteArray text() const ;
 	logWindow m_logWindow ;
+	Logger::progressCoalescer m_progressUpdates ;
+	Logger::throughputMeter m_throughput ;
+	QTemporaryFile m_spillFile ;
+	size_t m_maxLines ;
+	size_t m_maxBytes ;
 	QPlainTextEdit& m_textEdit ;
 	Logger::Data m_lines ;
 	bool m_updateView = false ;
+	bool m_textEditIsStale = false ;
+	bool m_authenticationError = false ;
 } ;
 
 class LoggerWrapper
@@ -328,6 +781,10 @@ public:
 	{
 		m_logger->clear() ;
 	}
+	void flush()
+	{
+		m_logger->flush() ;
+	}
 	template< typename Function >
 	void add( const Function& function )
 	{
@@ -343,12 +800,12 @@ class loggerBatchDownloader
 {
 public:
 	loggerBatchDownloader( Function function,Logger& logger,FunctionUpdate ff,Error err,int id ) :
-		m_functionUpdate( std::move( ff ) ),
-		m_function( std::move( function ) ),
+		m_state( std::make_shared< state >( std::move( function ),std::move( ff ) ) ),
 		m_error( std::move( err ) ),
 		m_logger( logger ),
 		m_id( id )
 	{
+		m_logger.limit( m_state->lines ) ;
 	}
 	void add( const QString& e )
 	{
@@ -360,23 +817,44 @@ public:
 
         if( s.startsWith( "[UMD4]" ) ){
 
-			m_lines.add( s ) ;
+			m_state->lines.add( s ) ;
 		}else{
-            m_lines.add( "[UMD4] " + s ) ;
+            m_state->lines.add( "[UMD4] " + s ) ;
 		}
 
 		this->update() ;
 	}
 	void clear()
 	{
-		m_functionUpdate( "" ) ;
-		m_lines.clear() ;
+		m_logger.progressUpdates().cancel( m_id ) ;
+		m_state->functionUpdate( "" ) ;
+		m_state->lines.clear() ;
+	}
+	void flush()
+	{
+		m_logger.progressUpdates().flush( m_id ) ;
+		m_logger.flush() ;
 	}
 	template< typename F >
 	void add( const F& function )
 	{
 		m_logger.add( function,m_id ) ;
-		function( m_lines,-1,false ) ;
+		function( m_state->lines,-1,false ) ;
+
+		const auto& lines = m_state->lines ;
+		const auto& p = lines.downloadProgress() ;
+
+		/*
+		 * The stored progress outlives its line, post processing lines
+		 * must not keep a speed alive that is no longer there. An entry
+		 * that is not updated expires in the meter.
+		 */
+		if( lines.isNotEmpty() && lines.lastLineIsProgressLine() &&
+		    p.isSet() && p.speed >= 0 ){
+
+			m_logger.throughput().update( m_id,p.speed ) ;
+		}
+
 		this->update() ;
 	}
 	void logError( const QByteArray& data )
@@ -387,16 +865,43 @@ public:
 private:
 	void update()
 	{
-		if( m_lines.isNotEmpty() ){
+		if( m_state->lines.isNotEmpty() ){
+
+			auto& updates = m_logger.progressUpdates() ;
+
+			if( m_state->lines.lastLineIsProgressLine() ){
+
+				auto state = m_state ;
 
-			m_functionUpdate( m_function( m_lines ) ) ;
+				updates.post( m_id,[ state ](){ state->update() ; } ) ;
+			}else{
+				/*
+				 * Anything other than a progress line is a change of state
+				 * (destination,merging,errors etc) and is shown right away.
+				 */
+				updates.cancel( m_id ) ;
+
+				m_state->update() ;
+			}
 		}
 	}
-	FunctionUpdate m_functionUpdate ;
-	Function m_function ;
+	struct state
+	{
+		state( Function f,FunctionUpdate u ) :
+			function( std::move( f ) ),functionUpdate( std::move( u ) )
+		{
+		}
+		void update()
+		{
+			functionUpdate( function( lines ) ) ;
+		}
+		Function function ;
+		FunctionUpdate functionUpdate ;
+		Logger::Data lines ;
+	} ;
+	std::shared_ptr< state > m_state ;
 	Error m_error ;
 	Logger& m_logger ;
-	Logger::Data m_lines ;
 	int m_id ;
 } ;
 
@@ -452,6 +957,10 @@ public:
 	{
 		m_logger.logError( data,m_id ) ;
 	}
+	void flush()
+	{
+		m_logger.flush() ;
+	}
 private:
 	TableWidget& m_table ;
 	Logger& m_logger ;
@@ -32,16 +32,22 @@ logWindow::logWindow(QWidget *parent, settings &s, Logger &logger)
   m_ui->setupUi(this);
 
   m_ui->plainTextEdit->setReadOnly(true);
+  m_ui->plainTextEdit->setUndoRedoEnabled(false);
 
   connect(m_ui->pbClose, &QPushButton::clicked, [this]() { this->Hide(); });
 
   connect(m_ui->pbClear, &QPushButton::clicked,
           [&logger]() { logger.clear(); });
+
+  connect(m_ui->pbLoadOlder, &QPushButton::clicked,
+          [this, &logger]() { this->loadOlderLines(logger); });
 }
 
 logWindow::~logWindow() { delete m_ui; }
 
 void logWindow::setText(const QByteArray &e) {
+  m_spillPosition = -1;
+  m_ui->pbLoadOlder->setEnabled(true);
   m_ui->plainTextEdit->setPlainText(e);
   m_ui->plainTextEdit->moveCursor(QTextCursor::End);
 }
@@ -53,6 +59,128 @@ void logWindow::update(const QByteArray &e) {
   }
 }
 
+bool logWindow::update(bool reset, int evictedBlocks, int removedBlocks,
+                       const QByteArray &e) {
+  if (!this->isVisible()) {
+
+    return false;
+  }
+
+  if (reset) {
+
+    this->setText(e);
+
+    return false;
+  }
+
+  // dropped lines stay on display once older lines were asked for, they
+  // now follow the loaded ones in the spill file
+  if (m_spillPosition == -1) {
+
+    logWindow::removeFirstBlocks(*m_ui->plainTextEdit, evictedBlocks);
+  }
+
+  logWindow::replaceLastBlocks(*m_ui->plainTextEdit, removedBlocks, e);
+
+  if (m_spillPosition == -1) {
+
+    return false;
+  }
+
+  auto max = static_cast<int>(m_settings.logMaxLines());
+
+  // the loaded lines are kept until as many new lines came in as the log
+  // holds, the window then starts over from the log
+  auto blocks = m_ui->plainTextEdit->document()->blockCount();
+
+  return max > 0 && blocks > m_loadedBlockCount + max;
+}
+
+void logWindow::removeFirstBlocks(QPlainTextEdit &edit, int blocks) {
+  auto doc = edit.document();
+
+  if (blocks <= 0 || doc->isEmpty()) {
+
+    return;
+  }
+
+  if (blocks >= doc->blockCount()) {
+
+    edit.clear();
+
+    return;
+  }
+
+  QTextCursor cursor(doc);
+
+  cursor.setPosition(doc->findBlockByNumber(blocks).position(),
+                     QTextCursor::KeepAnchor);
+  cursor.removeSelectedText();
+}
+
+void logWindow::loadOlderLines(Logger &logger) {
+  auto m = logger.spilledText(m_spillPosition, 64 * 1024);
+
+  m_ui->pbLoadOlder->setEnabled(m_spillPosition > 0);
+
+  if (m.isEmpty()) {
+
+    return;
+  }
+
+  auto doc = m_ui->plainTextEdit->document();
+
+  if (!doc->isEmpty()) {
+
+    m += "\n";
+  }
+
+  QTextCursor cursor(doc);
+
+  cursor.insertText(QString::fromUtf8(m));
+
+  m_loadedBlockCount = doc->blockCount();
+}
+
+void logWindow::replaceLastBlocks(QPlainTextEdit &edit, int removedBlocks,
+                                  const QByteArray &e) {
+  auto doc = edit.document();
+
+  auto blockCount = doc->isEmpty() ? 0 : doc->blockCount();
+
+  if (removedBlocks >= blockCount) {
+
+    edit.setPlainText(e);
+    edit.moveCursor(QTextCursor::End);
+
+    return;
+  }
+
+  QTextCursor cursor(doc);
+
+  cursor.beginEditBlock();
+
+  cursor.movePosition(QTextCursor::End);
+
+  if (removedBlocks > 0) {
+
+    auto block = doc->findBlockByNumber(blockCount - removedBlocks);
+
+    // also take out the line break that ends the block before it
+    cursor.setPosition(block.position() - 1, QTextCursor::KeepAnchor);
+    cursor.removeSelectedText();
+  }
+
+  if (!e.isEmpty()) {
+
+    cursor.insertText("\n" + QString::fromUtf8(e));
+  }
+
+  cursor.endEditBlock();
+
+  edit.moveCursor(QTextCursor::End);
+}
+
 void logWindow::Hide() {
   const auto &r = this->window()->geometry();
 
@@ -90,7 +218,11 @@ void logWindow::Show() {
   this->show();
 }
 
-void logWindow::clear() { m_ui->plainTextEdit->clear(); }
+void logWindow::clear() {
+  m_spillPosition = -1;
+  m_ui->pbLoadOlder->setEnabled(true);
+  m_ui->plainTextEdit->clear();
+}
 
 void logWindow::closeEvent(QCloseEvent *e) {
   e->ignore();
@@ -47,13 +47,23 @@ public:
 		this->update( e.toString() ) ;
 	}
 	void update( const QByteArray& e ) ;
+	/*
+	 * Returns true when the window dropped the older lines it had loaded
+	 * and has to be given the whole log again with setText().
+	 */
+	bool update( bool reset,int evictedBlocks,int removedBlocks,const QByteArray& e ) ;
+	static void replaceLastBlocks( QPlainTextEdit&,int removedBlocks,const QByteArray& ) ;
+	static void removeFirstBlocks( QPlainTextEdit&,int blocks ) ;
 	void Hide() ;
 	void Show() ;
 	void clear() ;
 private:
 	void closeEvent( QCloseEvent * ) override ;
+	void loadOlderLines( Logger& ) ;
 	Ui::logWindow * m_ui ;
 	settings& m_settings ;
+	qint64 m_spillPosition = -1 ;
+	int m_loadedBlockCount = 0 ;
 };
 
 #endif // LOGWINDOW_H
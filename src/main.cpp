@@ -6,6 +6,8 @@
 
 #include <QMessageBox>
 
+#include <cstring>
+
 class myApp {
 public:
   struct args {
@@ -15,17 +17,25 @@ public:
   };
   myApp(const myApp::args &args)
       : m_traslator(args.Settings, args.app),
-        m_app(args.app, args.Settings, m_traslator, args.args) {}
+        m_app(args.app, args.Settings, m_traslator, args.args),
+        m_headless(args.args.contains("--headless")) {}
   void start(const QByteArray &e) {
-    m_app.Show();
+    if (!m_headless) {
+
+      m_app.Show();
+    }
     m_app.processEvent(e);
   }
   void exit() { m_app.quitApp(); }
   void event(const QByteArray &e) { m_app.processEvent(e); }
+  void request(const QByteArray &e, rpcServer::reply reply) {
+    m_app.processRequest(e, std::move(reply));
+  }
 
 private:
   translator m_traslator;
   MainWindow m_app;
+  bool m_headless;
 };
 
 int main(int argc, char *argv[]) {
@@ -46,6 +56,16 @@ int main(int argc, char *argv[]) {
             "--ignore-gpu-blocklist "
             "--disable-extensions"); // --single-process
 
+    for (int i = 1; i < argc; i++) {
+
+      if (std::strcmp(argv[i], "--headless") == 0 &&
+          !qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+
+        // there may be no display to connect to
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+      }
+    }
+
     QApplication mqApp(argc, argv);
 
     mqApp.setApplicationName(APPLICATION_NAME);
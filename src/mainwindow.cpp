@@ -27,6 +27,7 @@
 
 #include "context.hpp"
 #include "settings.h"
+#include "thumbnailcache.h"
 #include "translator.h"
 
 #include <QScreen>
@@ -61,11 +62,22 @@ MainWindow::MainWindow(QApplication &app, settings &s, translator &t,
       m_logger(*m_ui->plainTextEditLogger, this, s), m_engines(m_logger, s),
       m_cou(*m_ui), m_tabManager(s, t, m_engines, m_logger, *m_ui, *this, *this,
                                  m_cou, _debug(args)),
-      m_settings(s), m_defaultWindowTitle(APPLICATION_NAME) {
+      m_settings(s), m_defaultWindowTitle(APPLICATION_NAME),
+      m_rpcServer(m_tabManager.batchDownloader()) {
   QIcon icon = QIcon::fromTheme(QApplication::applicationName(),
                                 QIcon(":/icons/app/icon-64.png"));
   this->window()->setWindowIcon(icon);
-  initRateWidget();
+
+  thumbnailCache::instance().setUp(m_settings.thumbnailCacheSize(),
+                                   m_settings.thumbnailCacheMaxAge());
+
+  utility::infoJsonCache::prune(m_settings);
+
+  auto headless = args.contains("--headless");
+
+  if (!headless) {
+    initRateWidget();
+  }
   m_ui.get()->ytSearchResultsListWidget->installEventFilter(this);
   restoreMainWindow();
 
@@ -83,8 +95,11 @@ MainWindow::MainWindow(QApplication &app, settings &s, translator &t,
   playerService->clearSocketDir();
   playerService->deleteLater();
 
-  initBrowser();
-  initToolbar();
+  // the browser is not needed when the app is driven over its socket
+  if (!headless) {
+    initBrowser();
+    initToolbar();
+  }
 }
 
 void MainWindow::handleEngineUpdateAvailable() {
@@ -297,6 +312,10 @@ void MainWindow::Show() { this->show(); }
 
 void MainWindow::processEvent(const QByteArray &e) { m_tabManager.gotEvent(e); }
 
+void MainWindow::processRequest(const QByteArray &e, rpcServer::reply reply) {
+  m_rpcServer.request(e, std::move(reply));
+}
+
 void MainWindow::quitApp() { m_tabManager.basicDownloader().appQuit(); }
 
 void MainWindow::log(const QByteArray &e) { m_logger.add(e, -1); }
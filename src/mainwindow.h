@@ -28,6 +28,7 @@
 #include "logger.h"
 #include "logwindow.h"
 #include "rateapp.h"
+#include "rpcserver.h"
 #include "tabmanager.h"
 
 #include <QApplication>
@@ -55,6 +56,7 @@ public:
   void resetTitle();
   void Show();
   void processEvent(const QByteArray &e);
+  void processRequest(const QByteArray &e, rpcServer::reply reply);
   void quitApp();
   void log(const QByteArray &);
   ~MainWindow() override;
@@ -84,6 +86,7 @@ private:
   tabManager m_tabManager;
   settings &m_settings;
   QString m_defaultWindowTitle;
+  rpcServer m_rpcServer;
 
   EngineUpdateCheck *m_engineUpdateCheck = nullptr;
   void initToolbar();
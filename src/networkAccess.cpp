@@ -50,7 +50,8 @@ static QString _sslLibraryVersionString()
 networkAccess::networkAccess( const Context& ctx ) :
 	m_ctx( ctx ),
 	m_basicdownloader( m_ctx.TabManager().basicDownloader() ),
-	m_tabManager( m_ctx.TabManager() )
+	m_tabManager( m_ctx.TabManager() ),
+	m_thumbnails( m_accessManager,m_ctx.Settings() )
 {
 	if( utility::platformIsWindows() && m_ctx.Settings().showVersionInfoWhenStarting() ){
 
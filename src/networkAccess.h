@@ -35,6 +35,7 @@
 #include "context.hpp"
 #include "settings.h"
 #include "engines.h"
+#include "thumbnailfetcher.h"
 
 class basicdownloader ;
 
@@ -60,10 +61,16 @@ public:
 		QObject::connect( networkReply,&QNetworkReply::finished,[ networkReply,function = std::move( function ) ](){
 
 			function( networkReply->readAll() ) ;
+
+			networkReply->deleteLater() ;
 		} ) ;
 	}
+	thumbnailFetcher& thumbnails()
+	{
+		return m_thumbnails ;
+	}
+	static QNetworkRequest networkRequest( const QString& url ) ;
 private:
-	QNetworkRequest networkRequest( const QString& url ) ;
 
 	struct metadata
 	{
@@ -78,6 +85,7 @@ private:
 	QFile m_file ;
 	basicdownloader& m_basicdownloader ;
 	tabManager& m_tabManager ;
+	thumbnailFetcher m_thumbnails ;
 };
 
 #endif
@@ -21,14 +21,20 @@
  */
 
 #include "playlistdownloader.h"
+#include "archiveindex.h"
 #include "networkAccess.h"
 #include "tableWidget.h"
 #include "tabmanager.h"
+#include "thumbnailcache.h"
 
 #include <QClipboard>
 #include <QFileDialog>
+#include <QScrollBar>
+#include <QUrl>
 #include <mainwindow.h>
 
+#include <algorithm>
+
 class playlistdownloader::customOptions {
 public:
   customOptions(QStringList &&opts, const QString &downloadArchivePath,
@@ -54,38 +60,23 @@ public:
         mm = downloadArchivePath;
       }
 
-      if (!mm.isEmpty()) {
-
-        if (utility::isRelativePath(mm)) {
-
-          mm = settings.downloadFolder() + "/" + mm;
-        }
-      }
-
-      if (!mm.isEmpty() && QFile::exists(mm)) {
-
-        QFile file(mm);
-
-        if (file.open(QIODevice::ReadOnly)) {
-
-          m_archiveFileData = file.readAll();
-        }
-      }
+      m_archive = archiveIndex::find(mm, settings);
     }
   }
   const QStringList &options() const { return m_options; }
+  void appendOptions(const QStringList &e) { m_options.append(e); }
   int maxMediaLength() const {
     return engines::engine::functions::timer::toSeconds(m_maxMediaLength);
   }
   int minMediaLength() const {
     return engines::engine::functions::timer::toSeconds(m_minMediaLength);
   }
-  bool contains(const QString &e) const {
-    if (m_archiveFileData.isEmpty()) {
+  bool contains(const utility::MediaEntry &e) const {
+    if (m_archive) {
 
-      return false;
+      return m_archive->contains(e.archiveId());
     } else {
-      return m_archiveFileData.contains(e.toUtf8() + "\n");
+      return false;
     }
   }
   bool breakOnExisting() const { return m_breakOnExisting; }
@@ -97,7 +88,7 @@ private:
   QStringList m_options;
   QString m_maxMediaLength;
   QString m_minMediaLength;
-  QByteArray m_archiveFileData;
+  archiveIndex *m_archive = nullptr;
 };
 
 playlistdownloader::playlistdownloader(Context &ctx)
@@ -106,7 +97,8 @@ playlistdownloader::playlistdownloader(Context &ctx)
       m_table(*m_ui.tableWidgetPl, m_ctx.mainWidget().font(), 1),
       m_ccmd(m_ctx, *m_ui.pbPLCancel, m_settings),
       m_defaultVideoThumbnailIcon(
-          m_settings.defaultVideoThumbnailIcon(settings::tabName::playlist)) {
+          m_settings.defaultVideoThumbnailIcon(settings::tabName::playlist)),
+      m_subscriptionRefresher(m_ctx) {
 
   this->resetMenu();
 
@@ -116,12 +108,17 @@ playlistdownloader::playlistdownloader(Context &ctx)
   m_table.get().setColumnWidth(
       0, m_ctx.Settings().thumbnailWidth(settings::tabName::playlist));
 
-  m_table.connect(&QTableWidget::currentItemChanged,
-                  [this](QTableWidgetItem *c, QTableWidgetItem *p) {
-                    m_table.selectRow(c, p, m_table.startPosition());
-                  });
+  m_resolveTimer.setSingleShot(true);
+  m_resolveTimer.setInterval(300);
+
+  connect(&m_resolveTimer, &QTimer::timeout,
+          [this]() { this->resolveVisible(); });
 
-  m_table.connect(&QTableWidget::customContextMenuRequested, [this](QPoint) {
+  // also moves thumbnails of the rows scrolled into view to the front
+  connect(m_table.get().verticalScrollBar(), &QScrollBar::valueChanged,
+          [this](int) { m_resolveTimer.start(); });
+
+  m_table.connect(&QTableView::customContextMenuRequested, [this](QPoint) {
     auto row = m_table.currentRow();
 
     auto function = [this](const utility::contextState &c) {
@@ -131,6 +128,8 @@ playlistdownloader::playlistdownloader(Context &ctx)
 
       } else if (c.clear()) {
 
+        m_ctx.versionInfo().network().thumbnails().cancel(m_table);
+
         m_table.clear();
       }
     };
@@ -175,6 +174,10 @@ playlistdownloader::playlistdownloader(Context &ctx)
     ac->setEnabled(m_table.noneAreRunning() && !m_networkRunning);
 
     connect(ac, &QAction::triggered, [this, row]() {
+      auto &thumbnails = m_ctx.versionInfo().network().thumbnails();
+
+      thumbnails.cancel(m_table, m_table.url(row));
+
       m_table.removeRow(row);
 
       m_ui.pbBDDownload->setEnabled(m_table.rowCount());
@@ -282,7 +285,7 @@ playlistdownloader::playlistdownloader(Context &ctx)
   connect(m_ui.pbPLCancel, &QPushButton::clicked, [this]() {
     m_networkRunning = 0;
 
-    m_terminator.terminateAll(m_table.get());
+    m_terminator.terminateAll(m_table);
   });
 
   connect(m_ui.pbPLOptionsHistory, &QPushButton::clicked, [this]() {
@@ -310,18 +313,35 @@ playlistdownloader::playlistdownloader(Context &ctx)
   connect(m_ui.pbPLGetListOptionHelp, &QPushButton::clicked,
           [=]() { utility::openGetListOptionHelp(); });
 
-  m_table.connect(&QTableWidget::cellDoubleClicked,
-                  [this](int row, int column) {
-                    Q_UNUSED(column)
+  m_table.connect(&QTableView::doubleClicked, [this](const QModelIndex &m) {
+    auto row = m.row();
+
+    const auto &engine = utility::resolveEngine(m_table, this->defaultEngine(),
+                                                m_ctx.Engines(), row);
+
+    m_ctx.Engines().openUrls(m_table, row, engine);
+  });
+
+  connect(m_ui.pbPLCancel, &QPushButton::clicked, [this]() {
+    m_ccmd.cancelled();
+
+    // listings that did not start are dropped, running ones are stopped
+    for (auto it = m_listingJobs.begin(); it != m_listingJobs.end();) {
 
-                    const auto &engine = utility::resolveEngine(
-                        m_table, this->defaultEngine(), m_ctx.Engines(), row);
+      if (it->second.started) {
 
-                    m_ctx.Engines().openUrls(m_table, row, engine);
-                  });
+        // a listing whose options are still being built has no process
+        // yet, runListing() does not start it
+        it->second.stopped = true;
 
-  connect(m_ui.pbPLCancel, &QPushButton::clicked,
-          [this]() { m_ccmd.cancelled(); });
+        m_terminator.terminate(playlistdownloader::listingId(it->first));
+
+        it++;
+      } else {
+        it = m_listingJobs.erase(it);
+      }
+    }
+  });
 
   connect(m_ui.pbPLGetList, &QPushButton::clicked, [this]() {
     auto m = m_ui.lineEditPLUrl->text();
@@ -330,12 +350,30 @@ playlistdownloader::playlistdownloader(Context &ctx)
 
       m_autoDownload = false;
 
-      this->getList(m);
+      auto urls = util::split(m, ' ', true);
+
+      if (urls.size() > 1) {
+
+        std::vector<subscription::entry> e;
+
+        // listIterator walks its entries from the back
+        for (auto it = urls.rbegin(); it != urls.rend(); it++) {
+
+          e.emplace_back(*it);
+        }
+
+        this->getList(listIterator(std::move(e)));
+      } else {
+        this->getList(m);
+      }
     }
   });
 }
 
-void playlistdownloader::init_done() {}
+void playlistdownloader::init_done() {
+  // feeds with a refresh interval of 0 are skipped by the refresher
+  m_subscriptionRefresher.start();
+}
 
 void playlistdownloader::enableAll() {
   m_ui.pbPLPasteClipboard->setEnabled(true);
@@ -467,7 +505,9 @@ void playlistdownloader::download(const engines::engine &engine) {
   downloadManager::index indexes(m_table);
 
   auto _add = [&](int s, const QString &opts) {
-    auto validUrl = !m_table.url(s).isEmpty();
+    const auto &url = m_table.url(s);
+
+    auto validUrl = !url.isEmpty() && !m_filtered.count(url);
 
     auto e = m_table.runningState(s);
 
@@ -479,9 +519,9 @@ void playlistdownloader::download(const engines::engine &engine) {
 
         if (u.isEmpty()) {
 
-          indexes.add(s, opts);
+          indexes.add(s, this->lengthFilter(s, opts));
         } else {
-          indexes.add(s, u);
+          indexes.add(s, this->lengthFilter(s, u));
         }
       }
     }
@@ -512,7 +552,8 @@ void playlistdownloader::download(const engines::engine &eng, int index) {
     auto bb = [&engine, index, this](const downloadManager::finishedStatus &f) {
       utility::updateFinishedState(engine, m_settings, m_table, f);
 
-      if (m_table.noneAreRunning()) {
+      // streamed downloads can finish before listing does
+      if (m_table.noneAreRunning() && !m_gettingPlaylist) {
 
         m_ctx.TabManager().enableAll();
 
@@ -564,35 +605,275 @@ void playlistdownloader::download(const engines::engine &eng, int index) {
                   std::move(logger));
 }
 
-void playlistdownloader::getList(playlistdownloader::listIterator iter) {
-  m_dataReceived = false;
-  m_stoppedOnExisting = false;
-  m_meaw = false;
+void playlistdownloader::downloadListed(int row) {
+  auto u = m_table.downloadingOptions(row);
 
-  auto url = iter.url();
+  if (u.isEmpty()) {
 
-  url = util::split(url, ' ', true).first();
+    u = m_ui.lineEditPLUrlOptions->text();
+  }
 
-  m_ui.lineEditPLUrl->setText(url);
+  u = this->lengthFilter(row, u);
 
-  m_ui.pbPLCancel->setEnabled(true);
+  if (m_ccmd.running()) {
 
-  const auto &engine = this->defaultEngine();
+    m_ccmd.append(row, u);
+  } else {
+    downloadManager::index indexes(m_table);
 
-  auto opts = engine.dumpJsonArguments();
+    indexes.add(row, u);
 
-  auto listOpts = iter.listOptions();
+    this->download(this->defaultEngine(), std::move(indexes));
+  }
+}
 
-  if (listOpts.isEmpty()) {
+QString playlistdownloader::lengthFilter(int row, const QString &options) {
+  auto it = m_unresolved.find(m_table.url(row));
 
-    listOpts = m_ui.lineEditPLDownloadRange->text();
+  if (it == m_unresolved.end()) {
 
-    if (!listOpts.isEmpty()) {
+    return options;
+  }
 
-      m_settings.addToplaylistRangeHistory(listOpts);
+  const auto &e = it->second;
 
-      m_settings.setPlaylistRangeHistoryLastUsed(listOpts);
+  // the engine checks the limits of entries whose duration is not known,
+  // entries without a duration are not skipped
+  QStringList m;
+
+  if (e.maxLength > 0) {
+
+    m.append(QString("duration<=?%1").arg(e.maxLength));
+  }
+
+  if (e.minLength > 0) {
+
+    m.append(QString("duration>=?%1").arg(e.minLength));
+  }
+
+  if (m.isEmpty()) {
+
+    return options;
+  } else {
+    return options + " --match-filters " + m.join("&");
+  }
+}
+
+QString playlistdownloader::thumbnailCacheKey(const QString &url) {
+  auto w = m_settings.thumbnailWidth(settings::tabName::playlist);
+  auto h = m_settings.thumbnailHeight(settings::tabName::playlist);
+
+  return thumbnailCache::key(url, static_cast<int>(w), static_cast<int>(h));
+}
+
+void playlistdownloader::cacheThumbnail(const QString &key,
+                                        const QByteArray &data,
+                                        std::function<void(bool)> function) {
+  auto w = m_settings.thumbnailWidth(settings::tabName::playlist);
+  auto h = m_settings.thumbnailHeight(settings::tabName::playlist);
+
+  thumbnailCache::instance().add(key, data, static_cast<int>(w),
+                                 static_cast<int>(h), std::move(function));
+}
+
+void playlistdownloader::resolveVisible() {
+  if (networkAccess::hasNetworkSupport()) {
+
+    m_ctx.versionInfo().network().thumbnails().prioritise(m_table);
+  }
+
+  auto &table = m_table.get();
+
+  auto first = table.rowAt(0);
+
+  if (first == -1) {
+
+    return;
+  }
+
+  auto last = table.rowAt(table.viewport()->height() - 1);
+
+  if (last == -1) {
+
+    last = m_table.rowCount() - 1;
+  }
+
+  auto max = m_settings.maxConcurrentMetadataFetches();
+
+  for (int row = first; row <= last && m_resolving < max; row++) {
+
+    auto e = m_table.runningState(row);
+
+    auto it = m_unresolved.find(m_table.url(row));
+
+    if (it != m_unresolved.end() && !it->second.tried &&
+        downloadManager::finishedStatus::notStarted(e)) {
+
+      this->resolve(this->defaultEngine(), row);
+    }
+  }
+}
+
+static int _row(tableWidget &table, int row, const QString &url) {
+  if (row < table.rowCount() && table.url(row) == url) {
+
+    return row;
+  }
+
+  for (int i = 0; i < table.rowCount(); i++) {
+
+    if (table.url(i) == url) {
+
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+void playlistdownloader::resolve(const engines::engine &engine, int row) {
+  auto url = m_table.url(row);
+
+  // the row stays unresolved until its metadata arrives
+  m_unresolved[url].tried = true;
+
+  m_resolving++;
+
+  auto args = engine.dumpJsonArguments();
+
+  args.append(utility::infoJsonCache::writeArguments(engine, m_settings));
+
+  const QString cookiePath = m_settings.cookieFilePath(engine.name());
+  const QString ca = engine.cookieArgument();
+
+  if (!cookiePath.isEmpty() && !ca.isEmpty()) {
+    args.append(ca);
+    args.append(cookiePath);
+  }
+
+  args.append(url);
+
+  engines::engine::exeArgs::cmd cmd(engine.exePath(), args);
+
+  util::run(cmd.exe(), cmd.args(), [this, row, url](const util::run_result &r) {
+    m_resolving--;
+
+    const auto &data = r.stdOut;
+
+    auto start = data.indexOf('{');
+    auto end = data.lastIndexOf('}');
+
+    utility::MediaEntry media("", data.mid(start, end - start + 1));
+
+    auto index = _row(m_table, row, url);
+
+    auto state = index == -1 ? QString() : m_table.runningState(index);
+
+    // the table may have been cleared while the metadata was fetched
+    auto it = m_unresolved.find(url);
+
+    if (it != m_unresolved.end() && r.success() && start != -1 &&
+        media.valid() && downloadManager::finishedStatus::notStarted(state)) {
+
+      auto limits = it->second;
+
+      m_unresolved.erase(it);
+
+      utility::infoJsonCache::save(media);
+
+      auto d = media.intDuration();
+
+      if ((limits.maxLength > 0 && d > limits.maxLength) ||
+          (limits.minLength > 0 && d < limits.minLength)) {
+
+        m_filtered.insert(url);
+
+        auto m = tr("Skipped, outside the media length limits");
+
+        m_table.setUiText(m + "\n" + media.uiText(), index);
+
+      } else {
+        m_table.setUiText(media.uiText(), index);
+
+        const auto &u = media.thumbnailUrl();
+
+        auto key = this->thumbnailCacheKey(u);
+
+        auto show = [this, index, url, key]() {
+          auto row = _row(m_table, index, url);
+
+          if (row == -1) {
+
+            return;
+          }
+
+          tableWidget::entry e(m_defaultVideoThumbnailIcon, m_table.uiText(row),
+                               url, m_table.runningState(row));
+
+          e.thumbnail.key = key;
+          e.downloadingOptions = m_table.downloadingOptions(row);
+          e.downloadingOptionsUi = m_table.downloadingOptionsUi(row);
+          e.engineName = m_table.engineName(row);
+          e.archiveId = m_table.archiveId(row);
+
+          m_table.replace(std::move(e), row);
+        };
+
+        if (!u.isEmpty() && thumbnailCache::instance().contains(key)) {
+
+          show();
+
+        } else if (!u.isEmpty() && networkAccess::hasNetworkSupport()) {
+
+          auto &network = m_ctx.versionInfo().network();
+
+          auto &thumbnails = network.thumbnails();
+
+          thumbnails.fetch(
+              m_table, url, u,
+              [this, key, show](const QByteArray &data, bool cancelled) {
+                if (cancelled) {
+
+                  return;
+                }
+
+                this->cacheThumbnail(key, data, [show](bool m) {
+                  if (m) {
+
+                    show();
+                  }
+                });
+              });
+        }
+      }
     }
+
+    this->resolveVisible();
+  });
+}
+
+void playlistdownloader::listingFinished() {
+  m_gettingPlaylist = false;
+
+  // streamed downloads keep the ui disabled until they are done
+  if (!m_ccmd.running()) {
+
+    m_ctx.TabManager().enableAll();
+    m_ui.pbPLCancel->setEnabled(false);
+  }
+}
+
+QStringList
+playlistdownloader::listingArguments(const engines::engine &engine,
+                                     const QString &url,
+                                     const QString &listOpts) {
+  auto opts = engine.dumpJsonArguments();
+
+  if (m_flatListing) {
+
+    opts.append("--flat-playlist");
+  } else {
+    opts.append(utility::infoJsonCache::writeArguments(engine, m_settings));
   }
 
   if (!listOpts.isEmpty()) {
@@ -621,6 +902,62 @@ void playlistdownloader::getList(playlistdownloader::listIterator iter) {
     opts.append(cookiePath);
   }
 
+  return opts;
+}
+
+void playlistdownloader::getList(playlistdownloader::listIterator iter) {
+  m_dataReceived = false;
+  m_stoppedOnExisting = false;
+  m_meaw = false;
+  m_streamDownloads = m_settings.playlistDownloadWhileListing();
+
+  const auto &engine = this->defaultEngine();
+
+  m_flatListing = m_settings.playlistFlatListing() && engine.likeYoutubeDl() &&
+                  engine.name() != "youtube-dl";
+
+  if (iter.hasNext() && m_settings.playlistConcurrentListings() > 1) {
+
+    this->getLists(engine, iter.entries());
+
+    return;
+  }
+
+  auto url = iter.url();
+
+  url = util::split(url, ' ', true).first();
+
+  m_ui.lineEditPLUrl->setText(url);
+
+  m_ui.pbPLCancel->setEnabled(true);
+
+  auto listOpts = iter.listOptions();
+
+  if (listOpts.isEmpty()) {
+
+    listOpts = m_ui.lineEditPLDownloadRange->text();
+
+    if (!listOpts.isEmpty()) {
+
+      m_settings.addToplaylistRangeHistory(listOpts);
+
+      m_settings.setPlaylistRangeHistoryLastUsed(listOpts);
+    }
+  }
+
+  auto shards = m_settings.playlistListingShards();
+
+  // a playlist is only split when the whole of it is listed
+  if (!listOpts.isEmpty() || !engine.likeYoutubeDl() ||
+      engine.playlistItemsArgument().isEmpty()) {
+
+    shards = 1;
+  }
+
+  m_listingOrder.reset(shards > 1 ? shards : 0);
+
+  auto opts = this->listingArguments(engine, url, listOpts);
+
   m_networkRunning = 0;
 
   util::runInBgThread(
@@ -628,35 +965,61 @@ void playlistdownloader::getList(playlistdownloader::listIterator iter) {
         return customOptions(std::move(opts), QString(""), m_settings, engine);
       },
       [this, &engine, iter = std::move(iter)](customOptions &&c) mutable {
-        this->getList(std::move(c), engine, std::move(iter));
+        auto shards = m_listingOrder.shards();
+
+        if (shards > 1) {
+
+          for (int s = 0; s < shards; s++) {
+
+            auto m = c;
+
+            auto items = QString("%1::%2").arg(s + 1).arg(shards);
+
+            m.appendOptions({engine.playlistItemsArgument(), items});
+
+            this->getList(std::move(m), engine, iter, s);
+          }
+        } else {
+          this->getList(std::move(c), engine, std::move(iter));
+        }
       });
 }
 
 void playlistdownloader::getList(customOptions &&c,
                                  const engines::engine &engine,
-                                 playlistdownloader::listIterator iter) {
+                                 playlistdownloader::listIterator iter,
+                                 int shard) {
   auto functions = utility::OptionsFunctions(
       [this](const playlistdownloader::opts &opts) {
         opts.ctx.TabManager().disableAll();
         m_gettingPlaylist = true;
         m_ui.pbPLCancel->setEnabled(true);
       },
-      [this, iter = std::move(iter)](utility::ProcessExitState st,
-                                     const playlistdownloader::opts &) {
+      [this, iter = std::move(iter), shard](utility::ProcessExitState st,
+                                            const playlistdownloader::opts &) {
+        if (shard != -1) {
+
+          m_listingOrder.finished(shard);
+
+          // the last shard to finish moves on
+          if (!m_listingOrder.finished()) {
+
+            return;
+          }
+        }
+
         if (m_meaw) {
 
           if (iter.hasNext()) {
 
             this->getList(iter.next());
           } else {
-            if (m_autoDownload) {
+            if (m_autoDownload && !m_streamDownloads) {
 
               this->download();
             } else {
               m_showTimer = false;
-              m_ctx.TabManager().enableAll();
-              m_gettingPlaylist = false;
-              m_ui.pbPLCancel->setEnabled(false);
+              this->listingFinished();
             }
           }
 
@@ -667,18 +1030,14 @@ void playlistdownloader::getList(customOptions &&c,
             this->getList(iter.next());
           } else {
             m_showTimer = false;
-            m_ctx.TabManager().enableAll();
-            m_gettingPlaylist = false;
-            m_ui.pbPLCancel->setEnabled(false);
+            this->listingFinished();
           }
 
         } else if (iter.hasNext()) {
 
           this->getList(iter.next());
         } else {
-          m_ctx.TabManager().enableAll();
-          m_gettingPlaylist = false;
-          m_ui.pbPLCancel->setEnabled(false);
+          this->listingFinished();
 
           if (!m_dataReceived) {
 
@@ -711,48 +1070,281 @@ void playlistdownloader::getList(customOptions &&c,
   auto ch = QProcess::ProcessChannel::StandardOutput;
   auto argsq = utility::args(m_ui.lineEditPLUrlOptions->text()).quality();
 
-  if (!m_gettingPlaylist) {
+  if (!m_gettingPlaylist && shard < 1) {
 
     logger.clear();
 
-    auto s = tr("This may take some time");
-    auto d = engines::engine::functions::timer::stringElapsedTime(0);
+    this->showListingTimer();
+  }
 
-    QIcon icon(":/icons/clock.png");
+  m_table.selectLast();
 
-    auto w = m_settings.thumbnailWidth(settings::tabName::playlist);
-    auto h = m_settings.thumbnailHeight(settings::tabName::playlist);
+  auto ctx = utility::make_ctx(engine, std::move(oopts), std::move(logger),
+                               std::move(term), ch);
 
-    m_table.addItem({icon.pixmap(w, h), d + "\n" + s, "", ""});
+  utility::run(opts, argsq, std::move(ctx));
+}
 
-    m_showTimer = true;
+void playlistdownloader::showListingTimer() {
+  m_unresolved.clear();
+  m_filtered.clear();
 
-    util::Timer(1000, [this, s](int counter) {
-      using tt = engines::engine::functions;
+  auto s = tr("This may take some time");
+  auto d = engines::engine::functions::timer::stringElapsedTime(0);
 
-      auto duration = tt::timer::stringElapsedTime(counter * 1000);
+  QIcon icon(":/icons/clock.png");
 
-      if (m_showTimer) {
+  auto w = m_settings.thumbnailWidth(settings::tabName::playlist);
+  auto h = m_settings.thumbnailHeight(settings::tabName::playlist);
 
-        m_table.setUiText(duration + "\n" + s, 0);
+  m_table.addItem({icon.pixmap(w, h), d + "\n" + s, "", ""});
 
-        return false;
-      } else {
-        m_table.setUiText("Done listing playlist items\n " + duration, 0);
-        return true;
-      }
-    });
+  m_showTimer = true;
+
+  util::Timer(1000, [this, s](int counter) {
+    using tt = engines::engine::functions;
+
+    auto duration = tt::timer::stringElapsedTime(counter * 1000);
+
+    if (m_showTimer) {
+
+      m_table.setUiText(duration + "\n" + s, 0);
+
+      return false;
+    } else {
+      m_table.setUiText("Done listing playlist items\n " + duration, 0);
+      return true;
+    }
+  });
+}
+
+void playlistdownloader::getLists(const engines::engine &engine,
+                                  std::vector<subscription::entry> entries) {
+  m_listingOrder.reset(0);
+
+  m_listingJobs.clear();
+
+  for (auto &it : entries) {
+
+    listingJob job;
+
+    job.entry = std::move(it);
+
+    m_listingJobs.emplace(m_listingJobId++, std::move(job));
   }
 
-  m_table.selectLast();
+  m_ui.pbPLCancel->setEnabled(true);
+
+  m_networkRunning = 0;
+
+  m_table.clear();
+
+  this->showListingTimer();
+
+  this->startListings(engine);
+}
+
+static QString _host(const QString &url) {
+  auto m = QUrl(util::split(url, ' ', true).first()).host().toLower();
+
+  if (m.startsWith("www.")) {
+
+    m.remove(0, 4);
+  }
+
+  return m;
+}
+
+void playlistdownloader::startListings(const engines::engine &engine) {
+  auto max = m_settings.playlistConcurrentListings();
+  auto maxPerHost = m_settings.maxConcurrentDownloadsPerHost();
+
+  size_t running = 0;
+  std::map<QString, size_t> hosts;
+
+  for (const auto &it : m_listingJobs) {
+
+    if (it.second.started && !it.second.done) {
+
+      running++;
+      hosts[_host(it.second.entry.url)]++;
+    }
+  }
+
+  for (auto &it : m_listingJobs) {
+
+    if (running >= max) {
+
+      break;
+    }
+
+    auto &job = it.second;
+
+    if (job.started) {
+
+      continue;
+    }
+
+    auto &host = hosts[_host(job.entry.url)];
+
+    if (maxPerHost > 0 && host >= maxPerHost) {
+
+      continue;
+    }
+
+    job.started = true;
+
+    running++;
+    host++;
+
+    this->startListing(engine, it.first);
+  }
+}
+
+void playlistdownloader::startListing(const engines::engine &engine,
+                                      int job) {
+  const auto &entry = m_listingJobs[job].entry;
+
+  auto url = util::split(entry.url, ' ', true).first();
+
+  auto listOpts = entry.getListOptions;
+
+  if (listOpts.isEmpty()) {
+
+    listOpts = m_ui.lineEditPLDownloadRange->text();
+  }
+
+  auto opts = this->listingArguments(engine, url, listOpts);
+
+  util::runInBgThread(
+      [&engine, this, opts = std::move(opts)]() mutable {
+        return customOptions(std::move(opts), QString(""), m_settings, engine);
+      },
+      [this, &engine, job](customOptions &&c) {
+        this->runListing(std::move(c), engine, job);
+      });
+}
+
+void playlistdownloader::runListing(customOptions &&c,
+                                    const engines::engine &engine, int job) {
+  auto it = m_listingJobs.find(job);
+
+  if (it == m_listingJobs.end()) {
+
+    // the listings were replaced while the options were built
+    return;
+  }
+
+  if (it->second.stopped) {
+
+    it->second.done = true;
+
+    this->flushListings();
+
+    return;
+  }
+
+  auto functions = utility::OptionsFunctions(
+      [this](const playlistdownloader::opts &opts) {
+        opts.ctx.TabManager().disableAll();
+        m_gettingPlaylist = true;
+        m_ui.pbPLCancel->setEnabled(true);
+      },
+      [this, &engine, job](utility::ProcessExitState,
+                           const playlistdownloader::opts &) {
+        auto it = m_listingJobs.find(job);
+
+        if (it != m_listingJobs.end()) {
+
+          it->second.done = true;
+        }
+
+        this->flushListings();
+
+        this->startListings(engine);
+      });
+
+  auto opts = c.options();
+
+  auto bb = [copts = std::move(c), this, job](tableWidget &table,
+                                              Logger::Data &data) {
+    m_dataReceived = true;
+
+    while (true) {
+
+      if (this->parseJson(copts, table, data, job) == Loop::Break) {
+
+        break;
+      }
+    }
+  };
+
+  auto id = utility::concurrentID();
+  auto oopts = playlistdownloader::make_options(
+      {m_ctx, m_ctx.debug(), false, playlistdownloader::listingId(job)},
+      std::move(functions));
+  auto logger =
+      make_loggerPlaylistDownloader(m_table, m_ctx.logger(), id, std::move(bb));
+  auto ch = QProcess::ProcessChannel::StandardOutput;
+  auto argsq = utility::args(m_ui.lineEditPLUrlOptions->text()).quality();
 
   auto ctx = utility::make_ctx(engine, std::move(oopts), std::move(logger),
-                               std::move(term), ch);
+                               m_terminator.setUp(), ch);
 
   utility::run(opts, argsq, std::move(ctx));
 }
 
+void playlistdownloader::listed(int job, std::function<void()> function) {
+  auto it = m_listingJobs.find(job);
+
+  if (it == m_listingJobs.end()) {
+
+    return;
+  }
+
+  if (it == m_listingJobs.begin()) {
+
+    function();
+
+    this->flushListings();
+  } else {
+    it->second.entries.emplace_back(std::move(function));
+  }
+}
+
+void playlistdownloader::flushListings() {
+  while (!m_listingJobs.empty()) {
+
+    auto it = m_listingJobs.begin();
+
+    auto entries = std::move(it->second.entries);
+
+    it->second.entries.clear();
+
+    for (const auto &e : entries) {
+
+      e();
+    }
+
+    if (it->second.done && it->second.thumbnails == 0) {
+
+      m_listingJobs.erase(it);
+    } else {
+      break;
+    }
+  }
+
+  if (m_listingJobs.empty() && m_gettingPlaylist) {
+
+    m_showTimer = false;
+
+    this->listingFinished();
+  }
+}
+
 void playlistdownloader::clearScreen() {
+  m_ctx.versionInfo().network().thumbnails().cancel(m_table);
+
   m_table.clear();
 
   m_ui.lineEditPLUrlOptions->clear();
@@ -764,7 +1356,20 @@ bool playlistdownloader::enabled() { return m_ui.lineEditPLUrl->isEnabled(); }
 
 playlistdownloader::Loop
 playlistdownloader::parseJson(const customOptions &copts, tableWidget &table,
-                              Logger::Data &data) {
+                              Logger::Data &data, int job) {
+  if (job != -1) {
+
+    auto it = m_listingJobs.find(job);
+
+    // output that comes after a listing was stopped is dropped
+    if (it == m_listingJobs.end() || it->second.stopped) {
+
+      data.clear();
+
+      return Loop::Break;
+    }
+  }
+
   auto mmm = data.toLine();
 
   auto oo = mmm.indexOf('{');
@@ -815,14 +1420,56 @@ playlistdownloader::parseJson(const customOptions &copts, tableWidget &table,
     data.add(mmm.mid(index + 1));
   }
 
-  auto _show = [this, &table](const tableWidget::entry &e) {
-    auto row = table.addItem(e);
+  utility::infoJsonCache::save(media);
+
+  auto playlistIndex = media.playlistIndex();
+
+  auto ordered = m_listingOrder.shards() > 1 && playlistIndex > 0;
+
+  if (ordered) {
+
+    m_listingOrder.listed(playlistIndex);
+  }
+
+  // a flat listed entry may not have a thumbnail or a duration
+  auto lazy = m_flatListing &&
+              (media.thumbnailUrl().isEmpty() || media.intDuration() == 0);
+
+  playlistdownloader::unresolved limits;
+
+  limits.minLength = copts.minMediaLength();
+  limits.maxLength = copts.maxMediaLength();
+
+  auto _add = [this, &table, lazy, limits,
+               archiveId = media.archiveId()](tableWidget::entry e) {
+    e.archiveId = archiveId;
+
+    auto done = downloadManager::finishedStatus::finishedWithSuccess(
+        e.runningState);
+
+    if (lazy && !done) {
+
+      m_unresolved[e.url] = limits;
+
+      if (!m_resolveTimer.isActive()) {
+
+        m_resolveTimer.start();
+      }
+    }
+
+    auto row = table.addItem(std::move(e));
 
     m_ctx.TabManager().Configure().setDownloadOptions(row, table);
 
+    // the entry is downloaded while the rest of the list is still coming
+    if (m_streamDownloads && !done) {
+
+      this->downloadListed(row);
+    }
+
     if (!m_ui.pbPLCancel->isEnabled()) {
 
-      if (m_autoDownload) {
+      if (m_autoDownload && !m_streamDownloads) {
 
         this->download();
       } else {
@@ -831,11 +1478,44 @@ playlistdownloader::parseJson(const customOptions &copts, tableWidget &table,
     }
   };
 
-  if (copts.contains(media.id())) {
+  auto _show = [this, playlistIndex, ordered, job,
+                _add = std::move(_add)](tableWidget::entry e) {
+    if (job != -1) {
+
+      this->listed(job, [_add, e = std::move(e)]() { _add(e); });
+
+    } else if (ordered) {
+
+      m_listingOrder.ready(playlistIndex,
+                           [_add, e = std::move(e)]() { _add(e); });
+    } else {
+      _add(std::move(e));
+    }
+  };
+
+  auto _skip = [this, playlistIndex, ordered]() {
+    if (ordered) {
+
+      m_listingOrder.ready(playlistIndex, {});
+    }
+  };
+
+  if (copts.contains(media)) {
 
     if (copts.breakOnExisting()) {
 
+      if (job != -1) {
+
+        // only the listing of this url stops
+        m_listingJobs[job].stopped = true;
+
+        m_terminator.terminate(playlistdownloader::listingId(job));
+
+        return Loop::Break;
+      }
+
       m_stoppedOnExisting = true;
+      _skip();
       m_ui.pbPLCancel->click();
       return Loop::Break;
 
@@ -853,17 +1533,22 @@ playlistdownloader::parseJson(const customOptions &copts, tableWidget &table,
     }
   }
 
-  auto max = copts.maxMediaLength();
+  // lazy entries have no duration yet, resolve() checks their limits
+  auto max = lazy ? 0 : copts.maxMediaLength();
 
   if (max > 0 && media.intDuration() > max) {
 
+    _skip();
+
     return Loop::Continue;
   }
 
-  auto min = copts.minMediaLength();
+  auto min = lazy ? 0 : copts.minMediaLength();
 
   if (min > 0 && media.intDuration() < min) {
 
+    _skip();
+
     return Loop::Continue;
   }
 
@@ -871,7 +1556,30 @@ playlistdownloader::parseJson(const customOptions &copts, tableWidget &table,
 
   // table.selectLast() ;
 
-  if (networkAccess::hasNetworkSupport()) {
+  auto thumbnailKey = this->thumbnailCacheKey(media.thumbnailUrl());
+
+  auto _entry = [this, thumbnailKey, s](const utility::MediaEntry &media,
+                                        bool hasThumbnail) {
+    tableWidget::entry e(m_defaultVideoThumbnailIcon, media.uiText(),
+                         media.url(), s);
+
+    if (hasThumbnail) {
+
+      e.thumbnail.key = thumbnailKey;
+    }
+
+    return e;
+  };
+
+  if (media.thumbnailUrl().isEmpty()) {
+
+    _show(_entry(media, false));
+
+  } else if (thumbnailCache::instance().contains(thumbnailKey)) {
+
+    _show(_entry(media, true));
+
+  } else if (networkAccess::hasNetworkSupport()) {
 
     m_meaw = false;
 
@@ -879,31 +1587,60 @@ playlistdownloader::parseJson(const customOptions &copts, tableWidget &table,
 
     m_networkRunning++;
 
+    if (job != -1) {
+
+      m_listingJobs[job].thumbnails++;
+    }
+
     auto thumbnailUrl = media.thumbnailUrl();
 
-    network.getResource(thumbnailUrl, [this, s, _show = std::move(_show),
-                                       media = std::move(media)](
-                                          const QByteArray &data) {
-      QPixmap pixmap;
+    auto rowUrl = media.url();
 
-      if (pixmap.loadFromData(data)) {
+    auto finish = [this, job]() {
+      if (job != -1) {
 
-        auto width = m_settings.thumbnailWidth(settings::tabName::playlist);
-        auto height = m_settings.thumbnailHeight(settings::tabName::playlist);
+        auto it = m_listingJobs.find(job);
 
-        _show({pixmap.scaled(width, height, Qt::KeepAspectRatio,
-                             Qt::SmoothTransformation),
-               media.uiText(), media.url(), s});
-      } else {
-        _show({m_defaultVideoThumbnailIcon, media.uiText(), media.url(), s});
+        if (it != m_listingJobs.end()) {
+
+          it->second.thumbnails--;
+        }
       }
 
+      m_networkRunning--;
+    };
+
+    auto done = [finish, _entry = std::move(_entry), _show = std::move(_show),
+                 media = std::move(media)](bool decoded) {
+      _show(_entry(media, decoded));
+
       // table.selectLast() ;
 
-      m_networkRunning--;
-    });
+      finish();
+    };
+
+    auto &thumbnails = network.thumbnails();
+
+    thumbnails.fetch(
+        table, rowUrl, thumbnailUrl,
+        [this, thumbnailKey, done, finish, job](const QByteArray &data,
+                                                 bool cancelled) {
+          if (!cancelled) {
+
+            this->cacheThumbnail(thumbnailKey, data, done);
+
+          } else if (job != -1) {
+
+            // the row is gone, the job may still wait on its thumbnail
+            finish();
+
+            this->flushListings();
+          } else {
+            finish();
+          }
+        });
   } else {
-    _show({m_defaultVideoThumbnailIcon, media.uiText(), media.url(), s});
+    _show(_entry(media, false));
 
     // table.selectLast() ;
   }
@@ -911,6 +1648,94 @@ playlistdownloader::parseJson(const customOptions &copts, tableWidget &table,
   return Loop::Continue;
 }
 
+void playlistdownloader::listingOrder::reset(int shards) {
+  m_next = 1;
+  m_last.assign(static_cast<size_t>(shards), 0);
+  m_finished.assign(static_cast<size_t>(shards), false);
+  m_pending.clear();
+  m_ready.clear();
+}
+
+void playlistdownloader::listingOrder::listed(int index) {
+  if (index < m_next) {
+
+    return;
+  }
+
+  auto &last = m_last[static_cast<size_t>((index - 1) % this->shards())];
+
+  last = std::max(last, index);
+
+  m_pending.insert(index);
+}
+
+void playlistdownloader::listingOrder::ready(int index,
+                                             std::function<void()> function) {
+  m_pending.erase(index);
+
+  if (index < m_next) {
+
+    if (function) {
+
+      function();
+    }
+  } else {
+    m_ready[index] = std::move(function);
+
+    this->flush();
+  }
+}
+
+void playlistdownloader::listingOrder::finished(int shard) {
+  m_finished[static_cast<size_t>(shard)] = true;
+
+  this->flush();
+}
+
+bool playlistdownloader::listingOrder::finished() const {
+  return std::all_of(m_finished.begin(), m_finished.end(),
+                     [](bool e) { return e; });
+}
+
+void playlistdownloader::listingOrder::flush() {
+  while (!m_ready.empty()) {
+
+    auto it = m_ready.find(m_next);
+
+    if (it != m_ready.end()) {
+
+      auto function = std::move(it->second);
+
+      m_ready.erase(it);
+
+      m_next++;
+
+      if (function) {
+
+        function();
+      }
+
+      continue;
+    }
+
+    if (m_pending.count(m_next)) {
+
+      // its thumbnail is still being downloaded
+      break;
+    }
+
+    auto shard = static_cast<size_t>((m_next - 1) % this->shards());
+
+    if (m_finished[shard] || m_last[shard] > m_next) {
+
+      // the shard moved past an item the engine did not list
+      m_next++;
+    } else {
+      break;
+    }
+  }
+}
+
 playlistdownloader::subscription::subscription(const Context &e,
                                                tableMiniWidget<int> &t,
                                                QWidget &w)
@@ -27,8 +27,16 @@
 #include "context.hpp"
 #include "downloadmanager.h"
 #include "settings.h"
+#include "subscriptionrefresher.h"
 #include "tableWidget.h"
 
+#include <QTimer>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <vector>
+
 class tabManager;
 
 class playlistdownloader : public QObject {
@@ -52,6 +60,14 @@ private:
   void download(const engines::engine &, downloadManager::index);
   void download(const engines::engine &);
   void download(const engines::engine &, int);
+  void downloadListed(int);
+  void listingFinished();
+  void resolveVisible();
+  void resolve(const engines::engine &, int);
+  QString lengthFilter(int, const QString &);
+  QString thumbnailCacheKey(const QString &url);
+  void cacheThumbnail(const QString &key, const QByteArray &data,
+                      std::function<void(bool)>);
 
   void clearScreen();
   bool enabled();
@@ -66,6 +82,22 @@ private:
   bool m_showThumbnails;
   bool m_showTimer;
   bool m_autoDownload;
+  bool m_streamDownloads = false;
+  bool m_flatListing = false;
+  size_t m_resolving = 0;
+  struct unresolved {
+    // the media length limits of the listing the row came from
+    int minLength = 0;
+    int maxLength = 0;
+    // a row whose metadata could not be fetched keeps its limits for the
+    // download but is not tried again
+    bool tried = false;
+  };
+  // flat listed rows whose metadata has not been fetched yet, keyed by url
+  std::map<QString, unresolved> m_unresolved;
+  // urls of rows left out by the media length limits once resolved
+  std::set<QString> m_filtered;
+  QTimer m_resolveTimer;
   bool m_stoppedOnExisting;
   bool m_meaw;
   bool m_dataReceived;
@@ -78,11 +110,13 @@ private:
 
   QPixmap m_defaultVideoThumbnailIcon;
 
+  subscriptionRefresher m_subscriptionRefresher;
+
   class customOptions;
 
   enum class Loop { Continue, Break };
   Loop parseJson(const playlistdownloader::customOptions &, tableWidget &table,
-                 Logger::Data &data);
+                 Logger::Data &data, int job = -1);
 
   struct opts {
     const Context &ctx;
@@ -137,13 +171,76 @@ private:
       m_list.pop_back();
       return std::move(m_list);
     }
+    std::vector<subscription::entry> entries() const {
+      return {m_list.rbegin(), m_list.rend()};
+    }
 
   private:
     mutable std::vector<subscription::entry> m_list;
   };
 
+  /*
+   * Adds entries listed by range sharded engine processes to the table in
+   * playlist order, shard "s" of "n" lists items s + 1, s + 1 + n ...
+   */
+  class listingOrder {
+  public:
+    void reset(int shards);
+    int shards() const { return static_cast<int>(m_last.size()); }
+    void listed(int index);
+    /*
+     * "function" adds the entry at "index", it is empty when the entry was
+     * filtered out.
+     */
+    void ready(int index, std::function<void()> function);
+    void finished(int shard);
+    bool finished() const;
+
+  private:
+    void flush();
+    int m_next = 1;
+    std::vector<int> m_last;
+    std::vector<bool> m_finished;
+    std::set<int> m_pending;
+    std::map<int, std::function<void()>> m_ready;
+  };
+
+  listingOrder m_listingOrder;
+
+  /*
+   * A listing of one of several urls that are listed at the same time, the
+   * rows of a listing are buffered until the listings before it are done so
+   * they are added to the table in the order of the urls.
+   */
+  struct listingJob {
+    subscription::entry entry;
+    bool started = false;
+    bool done = false;
+    bool stopped = false;
+    size_t thumbnails = 0;
+    std::vector<std::function<void()>> entries;
+  };
+
+  std::map<int, listingJob> m_listingJobs;
+  int m_listingJobId = 0;
+
+  // listings are stopped through the terminator with ids below the -1 used
+  // by a single listing
+  static int listingId(int job) { return -2 - job; }
+
+  QStringList listingArguments(const engines::engine &, const QString &url,
+                               const QString &listOptions);
+  void showListingTimer();
+  void getLists(const engines::engine &, std::vector<subscription::entry>);
+  void startListings(const engines::engine &);
+  void startListing(const engines::engine &, int job);
+  void runListing(customOptions &&, const engines::engine &, int job);
+  void listed(int job, std::function<void()>);
+  void flushListings();
+
   void getList(playlistdownloader::listIterator);
-  void getList(customOptions &&, const engines::engine &, listIterator);
+  void getList(customOptions &&, const engines::engine &, listIterator,
+               int shard = -1);
 
   // subscription m_subscription ;
 };
@@ -0,0 +1,342 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "rpcserver.h"
+#include "batchdownloader.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+
+rpcServer::rpcServer(batchdownloader &b) : m_batch(b) {
+  m_timer.setInterval(1000);
+
+  QObject::connect(&m_timer, &QTimer::timeout, [this]() { this->progress(); });
+}
+
+void rpcServer::request(const QByteArray &e, rpcServer::reply reply) {
+  QJsonParseError err;
+
+  auto doc = QJsonDocument::fromJson(e, &err);
+
+  if (err.error != QJsonParseError::NoError || !doc.isObject()) {
+
+    reply(rpcServer::error(QJsonValue(), -32700, "Parse error"));
+
+    return;
+  }
+
+  auto obj = doc.object();
+
+  auto id = obj.value("id");
+  auto method = obj.value("method").toString();
+  auto params = obj.value("params").toObject();
+
+  if (method == "enqueue") {
+
+    if (params.contains("options")) {
+
+      // the options end up on the command line of the engine, clients do
+      // not get to choose them
+      reply(rpcServer::error(id, -32602, "Invalid params"));
+    } else {
+      reply(rpcServer::result(id, this->enqueue(params)));
+    }
+
+  } else if (method == "bulk") {
+
+    reply(rpcServer::result(id, this->bulk(params, reply)));
+
+  } else if (method == "status") {
+
+    reply(rpcServer::result(id, this->status(params)));
+
+  } else if (method == "start") {
+
+    reply(rpcServer::result(id, m_batch.startQueued()));
+
+  } else if (method == "cancel") {
+
+    auto row = this->cancelRow(params);
+
+    if (row < -1) {
+
+      reply(rpcServer::error(id, -32602, "Invalid params"));
+    } else {
+      reply(rpcServer::result(id, this->cancel(row)));
+    }
+
+  } else if (method == "subscribe") {
+
+    if (reply(rpcServer::result(id, true))) {
+
+      m_subscribers.emplace_back(std::move(reply));
+
+      if (!m_timer.isActive()) {
+
+        m_rows.clear();
+
+        m_timer.start();
+      }
+    }
+  } else {
+    reply(rpcServer::error(id, -32601, "Method not found"));
+  }
+}
+
+QJsonValue rpcServer::enqueue(const QJsonObject &params) {
+  QStringList urls;
+
+  for (const auto &it : params.value("urls").toArray()) {
+
+    urls.append(it.toString());
+  }
+
+  auto download = params.value("download").toBool(true);
+
+  QJsonArray rows;
+
+  // the rows use the options of the batch tab
+  for (auto it : m_batch.enqueue(urls, QString(), download)) {
+
+    rows.append(it);
+  }
+
+  QJsonObject obj;
+
+  obj.insert("rows", rows);
+
+  return obj;
+}
+
+QJsonValue rpcServer::bulk(const QJsonObject &params,
+                           const rpcServer::reply &reply) {
+  QStringList urls;
+
+  if (params.contains("text")) {
+
+    for (const auto &it : params.value("text").toString().split('\n')) {
+
+      urls.append(it.trimmed());
+    }
+  } else {
+    for (const auto &it : params.value("urls").toArray()) {
+
+      urls.append(it.toString());
+    }
+  }
+
+  urls.removeAll(QString());
+
+  auto download = params.value("download").toBool(false);
+  auto thumbnails = params.value("thumbnails").toBool(true);
+
+  auto accepted = m_batch.admit(urls, download, thumbnails);
+
+  if (accepted < static_cast<size_t>(urls.size())) {
+
+    m_batch.whenAdmissionCredit([reply](size_t credit) {
+      QJsonObject params;
+
+      params.insert("credit", static_cast<qint64>(credit));
+
+      QJsonObject obj;
+
+      obj.insert("jsonrpc", "2.0");
+      obj.insert("method", "credit");
+      obj.insert("params", params);
+
+      reply(QJsonDocument(obj).toJson(QJsonDocument::Compact));
+    });
+  }
+
+  QJsonObject obj;
+
+  obj.insert("accepted", static_cast<qint64>(accepted));
+  obj.insert("credit", static_cast<qint64>(m_batch.admissionCredit()));
+
+  return obj;
+}
+
+QJsonValue rpcServer::status(const QJsonObject &params) {
+  auto &table = m_batch.table();
+
+  QJsonArray rows;
+
+  if (params.contains("rows")) {
+
+    for (const auto &it : params.value("rows").toArray()) {
+
+      auto row = it.toInt(-1);
+
+      if (row >= 0 && row < table.rowCount()) {
+
+        rows.append(this->row(row));
+      }
+    }
+  } else {
+    for (int row = 0; row < table.rowCount(); row++) {
+
+      rows.append(this->row(row));
+    }
+  }
+
+  QJsonObject obj;
+
+  obj.insert("rows", rows);
+  obj.insert("running", !table.noneAreRunning());
+
+  return obj;
+}
+
+int rpcServer::cancelRow(const QJsonObject &params) const {
+  if (!params.contains("row")) {
+
+    return -1;
+  }
+
+  auto m = params.value("row");
+
+  // -2 for anything that is not the index of a row
+  if (!m.isDouble()) {
+
+    return -2;
+  }
+
+  auto row = m.toDouble();
+
+  if (row < 0 || row >= m_batch.table().rowCount() ||
+      row != static_cast<int>(row)) {
+
+    return -2;
+  }
+
+  return static_cast<int>(row);
+}
+
+QJsonValue rpcServer::cancel(int row) {
+  m_batch.cancel(row);
+
+  return true;
+}
+
+QJsonObject rpcServer::row(int row) const {
+  auto &table = m_batch.table();
+
+  QJsonObject obj;
+
+  obj.insert("row", row);
+  obj.insert("url", table.url(row));
+  obj.insert("state", table.runningState(row));
+  obj.insert("text", table.uiText(row));
+
+  return obj;
+}
+
+void rpcServer::progress() {
+  auto &table = m_batch.table();
+
+  auto count = static_cast<size_t>(table.rowCount());
+
+  m_rows.resize(count);
+
+  QJsonArray rows;
+
+  for (size_t i = 0; i < count; i++) {
+
+    auto row = static_cast<int>(i);
+
+    const auto &state = table.runningState(row);
+    const auto &text = table.uiText(row);
+
+    auto &m = m_rows[i];
+
+    if (m.state != state || m.text != text) {
+
+      m.state = state;
+      m.text = text;
+
+      rows.append(this->row(row));
+    }
+  }
+
+  if (rows.isEmpty()) {
+
+    return;
+  }
+
+  QJsonObject params;
+
+  params.insert("rows", rows);
+  params.insert("count", table.rowCount());
+
+  QJsonObject obj;
+
+  obj.insert("jsonrpc", "2.0");
+  obj.insert("method", "progress");
+  obj.insert("params", params);
+
+  auto e = QJsonDocument(obj).toJson(QJsonDocument::Compact);
+
+  auto it = m_subscribers.begin();
+
+  while (it != m_subscribers.end()) {
+
+    if ((*it)(e)) {
+
+      it++;
+    } else {
+      // the client went away
+      it = m_subscribers.erase(it);
+    }
+  }
+
+  if (m_subscribers.empty()) {
+
+    m_timer.stop();
+  }
+}
+
+QByteArray rpcServer::result(const QJsonValue &id, const QJsonValue &e) {
+  QJsonObject obj;
+
+  obj.insert("jsonrpc", "2.0");
+  obj.insert("id", id);
+  obj.insert("result", e);
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
+
+QByteArray rpcServer::error(const QJsonValue &id, int code,
+                            const QString &message) {
+  QJsonObject err;
+
+  err.insert("code", code);
+  err.insert("message", message);
+
+  QJsonObject obj;
+
+  obj.insert("jsonrpc", "2.0");
+  obj.insert("id", id);
+  obj.insert("error", err);
+
+  return QJsonDocument(obj).toJson(QJsonDocument::Compact);
+}
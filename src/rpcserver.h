@@ -0,0 +1,84 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef RPCSERVER_H
+#define RPCSERVER_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QString>
+#include <QTimer>
+
+#include <functional>
+#include <vector>
+
+class batchdownloader;
+
+/*
+ * Json-rpc 2.0 control api served on the single instance socket.
+ *
+ * Methods:
+ *   enqueue   { "urls": [ ... ], "download": true }, rows use the options
+ *             of the batch tab
+ *   bulk      { "urls": [ ... ] or "text": "newline separated urls",
+ *               "download": false, "thumbnails": true }, urls go through
+ *             the admission queue of the batch tab, the reply has the number
+ *             of "accepted" urls and the "credit" left in the queue. When
+ *             urls were refused, a "credit" notification follows once the
+ *             queue has room again
+ *   status    { "rows": [ ... ] }, all rows when "rows" is missing
+ *   start     {}, downloads every row that did not finish successfully
+ *   cancel    { "row": n }, all downloads when "row" is missing
+ *   subscribe {}, progress of changed rows is then sent once a second as
+ *             "progress" notifications
+ *
+ * Invalid params, like an "options" member in enqueue or a "row" that is
+ * not in the table, get a -32602 error.
+ */
+class rpcServer {
+public:
+  using reply = std::function<bool(const QByteArray &)>;
+  rpcServer(batchdownloader &);
+  void request(const QByteArray &, rpcServer::reply);
+
+private:
+  QJsonValue enqueue(const QJsonObject &);
+  QJsonValue bulk(const QJsonObject &, const rpcServer::reply &);
+  QJsonValue status(const QJsonObject &);
+  int cancelRow(const QJsonObject &) const;
+  QJsonValue cancel(int row);
+  QJsonObject row(int) const;
+  void progress();
+  static QByteArray result(const QJsonValue &id, const QJsonValue &);
+  static QByteArray error(const QJsonValue &id, int code, const QString &);
+  struct rowState {
+    QString state;
+    QString text;
+  };
+  batchdownloader &m_batch;
+  QTimer m_timer;
+  std::vector<rpcServer::reply> m_subscribers;
+  std::vector<rowState> m_rows;
+};
+
+#endif
@@ -205,6 +205,152 @@ void settings::setMaxConcurrentDownloads(int s) {
   m_settings.setValue("MaxConcurrentDownloads", s);
 }
 
+size_t settings::maxConcurrentDownloadsPerHost() {
+  // 0 means downloads are only limited by MaxConcurrentDownloads
+  if (!m_settings.contains("MaxConcurrentDownloadsPerHost")) {
+
+    m_settings.setValue("MaxConcurrentDownloadsPerHost", 0);
+  }
+
+  return static_cast<size_t>(
+      m_settings.value("MaxConcurrentDownloadsPerHost").toInt());
+}
+
+void settings::setMaxConcurrentDownloadsPerHost(int s) {
+  m_settings.setValue("MaxConcurrentDownloadsPerHost", s);
+}
+
+size_t settings::maxConcurrentMetadataFetches() {
+  // engine processes fetching metadata of added urls, they run next to and
+  // are not counted against MaxConcurrentDownloads
+  if (!m_settings.contains("MaxConcurrentMetadataFetches")) {
+
+    m_settings.setValue("MaxConcurrentMetadataFetches", 2);
+  }
+
+  auto m = m_settings.value("MaxConcurrentMetadataFetches").toInt();
+
+  return m > 1 ? static_cast<size_t>(m) : 1;
+}
+
+void settings::setMaxConcurrentMetadataFetches(int s) {
+  m_settings.setValue("MaxConcurrentMetadataFetches", s);
+}
+
+bool settings::adaptiveConcurrentDownloads() {
+  // when set, MaxConcurrentDownloads is the most downloads that can run
+  // and the number that do run follows measured throughput
+  if (!m_settings.contains("AdaptiveConcurrentDownloads")) {
+
+    m_settings.setValue("AdaptiveConcurrentDownloads", false);
+  }
+
+  return m_settings.value("AdaptiveConcurrentDownloads").toBool();
+}
+
+void settings::setAdaptiveConcurrentDownloads(bool s) {
+  m_settings.setValue("AdaptiveConcurrentDownloads", s);
+}
+
+qint64 settings::bandwidthLimit() {
+  // in KiB per second for all downloads together, 0 means no limit
+  if (!m_settings.contains("BandwidthLimit")) {
+
+    m_settings.setValue("BandwidthLimit", 0);
+  }
+
+  return m_settings.value("BandwidthLimit").toLongLong();
+}
+
+void settings::setBandwidthLimit(qint64 s) {
+  m_settings.setValue("BandwidthLimit", s);
+}
+
+size_t settings::admissionQueueSize() {
+  // most urls that can wait to be added to the batch list
+  if (!m_settings.contains("AdmissionQueueSize")) {
+
+    m_settings.setValue("AdmissionQueueSize", 500);
+  }
+
+  return static_cast<size_t>(m_settings.value("AdmissionQueueSize").toInt());
+}
+
+void settings::setAdmissionQueueSize(int s) {
+  m_settings.setValue("AdmissionQueueSize", s);
+}
+
+size_t settings::metadataBatchSize() {
+  // number of urls whose metadata is fetched by one engine process, 1 uses
+  // a process per url
+  if (!m_settings.contains("MetadataBatchSize")) {
+
+    m_settings.setValue("MetadataBatchSize", 20);
+  }
+
+  auto m = m_settings.value("MetadataBatchSize").toInt();
+
+  return m > 1 ? static_cast<size_t>(m) : 1;
+}
+
+void settings::setMetadataBatchSize(int s) {
+  m_settings.setValue("MetadataBatchSize", s);
+}
+
+int settings::infoJsonMaxAge() {
+  // in seconds, how long metadata fetched for a row is used to download it,
+  // 0 always downloads from the url
+  if (!m_settings.contains("InfoJsonMaxAge")) {
+
+    m_settings.setValue("InfoJsonMaxAge", 1800);
+  }
+
+  return m_settings.value("InfoJsonMaxAge").toInt();
+}
+
+void settings::setInfoJsonMaxAge(int s) {
+  m_settings.setValue("InfoJsonMaxAge", s);
+}
+
+int settings::progressUpdateRate() {
+  // number of times per second download progress is shown, 0 shows every
+  // progress line as it arrives
+  if (!m_settings.contains("ProgressUpdateRate")) {
+
+    m_settings.setValue("ProgressUpdateRate", 15);
+  }
+
+  return m_settings.value("ProgressUpdateRate").toInt();
+}
+
+void settings::setProgressUpdateRate(int s) {
+  m_settings.setValue("ProgressUpdateRate", s);
+}
+
+size_t settings::logMaxLines() {
+  // lines kept in memory by the log, older ones go to a temporary file
+  if (!m_settings.contains("LogMaxLines")) {
+
+    m_settings.setValue("LogMaxLines", 5000);
+  }
+
+  return static_cast<size_t>(m_settings.value("LogMaxLines").toInt());
+}
+
+void settings::setLogMaxLines(int s) { m_settings.setValue("LogMaxLines", s); }
+
+size_t settings::logMaxSize() {
+  // in KiB
+  if (!m_settings.contains("LogMaxSize")) {
+
+    m_settings.setValue("LogMaxSize", 2048);
+  }
+
+  return static_cast<size_t>(m_settings.value("LogMaxSize").toInt());
+}
+
+void settings::setLogMaxSize(int s) { m_settings.setValue("LogMaxSize", s); }
+
 void settings::setDownloadFolder(const QString &m) {
   if (m.isEmpty()) {
 
@@ -413,6 +559,129 @@ void settings::setPlaylistDownloaderSaveHistory(bool e) {
   m_settings.setValue("PlaylistDownloaderSaveHistory", e);
 }
 
+bool settings::playlistDownloadWhileListing() {
+  // when set, playlist entries start downloading as soon as they are listed
+  if (!m_settings.contains("PlaylistDownloadWhileListing")) {
+
+    m_settings.setValue("PlaylistDownloadWhileListing", false);
+  }
+
+  return m_settings.value("PlaylistDownloadWhileListing").toBool();
+}
+
+void settings::setPlaylistDownloadWhileListing(bool e) {
+  m_settings.setValue("PlaylistDownloadWhileListing", e);
+}
+
+int settings::playlistListingShards() {
+  // number of engine processes that list a playlist without a download
+  // range, each one lists every n-th item
+  if (!m_settings.contains("PlaylistListingShards")) {
+
+    m_settings.setValue("PlaylistListingShards", 1);
+  }
+
+  auto m = m_settings.value("PlaylistListingShards").toInt();
+
+  return m > 1 ? m : 1;
+}
+
+void settings::setPlaylistListingShards(int s) {
+  m_settings.setValue("PlaylistListingShards", s);
+}
+
+bool settings::playlistFlatListing() {
+  // when set, playlists are listed with --flat-playlist and the metadata of
+  // an entry is fetched once it is shown or downloaded
+  if (!m_settings.contains("PlaylistFlatListing")) {
+
+    m_settings.setValue("PlaylistFlatListing", false);
+  }
+
+  return m_settings.value("PlaylistFlatListing").toBool();
+}
+
+void settings::setPlaylistFlatListing(bool e) {
+  m_settings.setValue("PlaylistFlatListing", e);
+}
+
+size_t settings::playlistConcurrentListings() {
+  // playlists listed at the same time when several urls are listed, hosts
+  // are also limited by MaxConcurrentDownloadsPerHost
+  if (!m_settings.contains("PlaylistConcurrentListings")) {
+
+    m_settings.setValue("PlaylistConcurrentListings", 4);
+  }
+
+  auto m = m_settings.value("PlaylistConcurrentListings").toInt();
+
+  return m > 1 ? static_cast<size_t>(m) : 1;
+}
+
+void settings::setPlaylistConcurrentListings(int s) {
+  m_settings.setValue("PlaylistConcurrentListings", s);
+}
+
+int settings::subscriptionRefreshInterval() {
+  // seconds between refreshes of a subscription, 0 disables refreshing
+  if (!m_settings.contains("SubscriptionRefreshInterval")) {
+
+    m_settings.setValue("SubscriptionRefreshInterval", 0);
+  }
+
+  return m_settings.value("SubscriptionRefreshInterval").toInt();
+}
+
+void settings::setSubscriptionRefreshInterval(int s) {
+  m_settings.setValue("SubscriptionRefreshInterval", s);
+}
+
+qint64 settings::thumbnailCacheSize() {
+  // megabytes of scaled thumbnails kept in memory
+  if (!m_settings.contains("ThumbnailCacheSize")) {
+
+    m_settings.setValue("ThumbnailCacheSize", 64);
+  }
+
+  auto m = m_settings.value("ThumbnailCacheSize").toInt();
+
+  return qint64(m > 1 ? m : 1) * 1024 * 1024;
+}
+
+void settings::setThumbnailCacheSize(int s) {
+  m_settings.setValue("ThumbnailCacheSize", s);
+}
+
+int settings::thumbnailCacheMaxAge() {
+  // days a thumbnail is kept on disk, 0 keeps them forever
+  if (!m_settings.contains("ThumbnailCacheMaxAge")) {
+
+    m_settings.setValue("ThumbnailCacheMaxAge", 30);
+  }
+
+  return m_settings.value("ThumbnailCacheMaxAge").toInt();
+}
+
+void settings::setThumbnailCacheMaxAge(int s) {
+  m_settings.setValue("ThumbnailCacheMaxAge", s);
+}
+
+int settings::thumbnailFetchesPerHost() {
+  // thumbnails downloaded from one host at the same time
+  if (!m_settings.contains("ThumbnailFetchesPerHost")) {
+
+    m_settings.setValue("ThumbnailFetchesPerHost", 4);
+  }
+
+  auto m = m_settings.value("ThumbnailFetchesPerHost").toInt();
+
+  return m > 1 ? m : 1;
+}
+
+void settings::setThumbnailFetchesPerHost(int s) {
+  m_settings.setValue("ThumbnailFetchesPerHost", s);
+}
+
 int settings::stringTruncationSize() {
   if (!m_settings.contains("StringTruncationSize")) {
 
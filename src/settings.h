@@ -53,6 +53,16 @@ public:
 
   int tabNumber();
   size_t maxConcurrentDownloads();
+  size_t maxConcurrentDownloadsPerHost();
+  size_t maxConcurrentMetadataFetches();
+  bool adaptiveConcurrentDownloads();
+  qint64 bandwidthLimit();
+  size_t admissionQueueSize();
+  size_t metadataBatchSize();
+  int infoJsonMaxAge();
+  int progressUpdateRate();
+  size_t logMaxLines();
+  size_t logMaxSize();
 
   QString downloadFolder();
   QString libraryDownloadFolder();
@@ -84,6 +94,14 @@ public:
   bool showThumbnails();
   bool saveHistory();
   bool playlistDownloaderSaveHistory();
+  bool playlistDownloadWhileListing();
+  int playlistListingShards();
+  bool playlistFlatListing();
+  size_t playlistConcurrentListings();
+  int subscriptionRefreshInterval();
+  qint64 thumbnailCacheSize();
+  int thumbnailCacheMaxAge();
+  int thumbnailFetchesPerHost();
 
   int stringTruncationSize();
   int historySize();
@@ -98,9 +116,27 @@ public:
   void addOptionsHistory(const QString &, settings::tabName);
   void setTheme(QApplication &);
   void setMaxConcurrentDownloads(int);
+  void setMaxConcurrentDownloadsPerHost(int);
+  void setMaxConcurrentMetadataFetches(int);
+  void setAdaptiveConcurrentDownloads(bool);
+  void setBandwidthLimit(qint64);
+  void setAdmissionQueueSize(int);
+  void setMetadataBatchSize(int);
+  void setInfoJsonMaxAge(int);
+  void setProgressUpdateRate(int);
+  void setLogMaxLines(int);
+  void setLogMaxSize(int);
   void setTabNumber(int);
   void setShowThumbnails(bool);
   void setPlaylistDownloaderSaveHistory(bool);
+  void setPlaylistDownloadWhileListing(bool);
+  void setPlaylistListingShards(int);
+  void setPlaylistFlatListing(bool);
+  void setPlaylistConcurrentListings(int);
+  void setSubscriptionRefreshInterval(int);
+  void setThumbnailCacheSize(int);
+  void setThumbnailCacheMaxAge(int);
+  void setThumbnailFetchesPerHost(int);
   void setShowVersionInfoWhenStarting(bool);
   void setDarkMode(const QString &);
   void setPlaylistRangeHistoryLastUsed(const QString &);
@@ -0,0 +1,378 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "subscriptionrefresher.h"
+#include "context.hpp"
+#include "settings.h"
+#include "tabmanager.h"
+#include "utility.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QSet>
+
+#include <algorithm>
+
+static qint64 _now() { return QDateTime::currentSecsSinceEpoch(); }
+
+subscriptionRefresher::subscriptionRefresher(const Context &ctx)
+    : m_ctx(ctx), m_subscriptionsPath(ctx.Engines().engineDirPaths().dataPath(
+                      "subscriptions.json")),
+      m_statePath(
+          ctx.Engines().engineDirPaths().dataPath("subscriptions_state.json")) {
+  m_timer.setSingleShot(true);
+
+  QObject::connect(&m_timer, &QTimer::timeout,
+                   [this]() { this->refreshDue(); });
+}
+
+void subscriptionRefresher::start() {
+  this->load();
+  this->schedule();
+}
+
+std::map<QString, subscriptionRefresher::subscription>
+subscriptionRefresher::subscriptions() {
+  std::map<QString, subscription> m;
+
+  QFile f(m_subscriptionsPath);
+
+  if (!f.open(QIODevice::ReadOnly)) {
+
+    return m;
+  }
+
+  auto interval = m_ctx.Settings().subscriptionRefreshInterval();
+
+  const auto array = QJsonDocument::fromJson(f.readAll()).array();
+
+  for (const auto &it : array) {
+
+    auto obj = it.toObject();
+
+    auto url = obj.value("url").toString();
+
+    if (url.isEmpty()) {
+
+      continue;
+    }
+
+    subscription s;
+
+    s.url = url;
+    s.listOptions = obj.value("getListOptions").toString();
+
+    // a feed may set its own interval in seconds, 0 turns it off
+    s.interval = obj.value("refreshInterval").toInt(interval);
+
+    m.emplace(url, std::move(s));
+  }
+
+  return m;
+}
+
+qint64 subscriptionRefresher::nextRefresh(const subscription &s,
+                                          qint64 lastRefresh) {
+  auto &random = *QRandomGenerator::global();
+
+  if (lastRefresh == 0) {
+
+    // spread the first refreshes out instead of starting them all at once
+    return _now() + random.bounded(60);
+  }
+
+  auto jitter = random.bounded(static_cast<int>(s.interval / 10) + 1);
+
+  return lastRefresh + s.interval + jitter;
+}
+
+void subscriptionRefresher::schedule() {
+  auto subscriptions = this->subscriptions();
+
+  qint64 next = -1;
+
+  for (const auto &it : subscriptions) {
+
+    const auto &s = it.second;
+
+    if (s.interval <= 0) {
+
+      continue;
+    }
+
+    auto &st = m_state[it.first];
+
+    if (st.due == 0) {
+
+      st.due = this->nextRefresh(s, st.lastRefresh);
+    }
+
+    if (!st.running && (next == -1 || st.due < next)) {
+
+      next = st.due;
+    }
+  }
+
+  if (next == -1) {
+
+    m_timer.stop();
+  } else {
+    // the file is read again when the timer fires, edits to it are picked
+    // up within the hour
+    auto wait = std::min(std::max(next - _now(), qint64(0)), qint64(3600));
+
+    m_timer.start(static_cast<int>(wait * 1000));
+  }
+}
+
+void subscriptionRefresher::refreshDue() {
+  auto max = m_ctx.Settings().playlistConcurrentListings();
+
+  auto now = _now();
+
+  for (const auto &it : this->subscriptions()) {
+
+    if (m_running >= max) {
+
+      break;
+    }
+
+    auto &st = m_state[it.first];
+
+    if (it.second.interval > 0 && !st.running && st.due != 0 &&
+        st.due <= now) {
+
+      st.running = true;
+
+      m_running++;
+
+      this->refresh(it.second);
+    }
+  }
+
+  this->schedule();
+}
+
+void subscriptionRefresher::refresh(const subscription &s) {
+  auto &settings = m_ctx.Settings();
+
+  auto name = settings.defaultEngine(settings::tabName::playlist,
+                                     m_ctx.Engines().defaultEngineName());
+
+  const auto &engine = m_ctx.Engines().defaultEngine(name);
+
+  auto url = s.url;
+
+  if (!engine.likeYoutubeDl()) {
+
+    this->refreshed(url, false, {});
+
+    return;
+  }
+
+  auto args = engine.dumpJsonArguments();
+
+  // the whole feed is listed, playlists add new entries at the end and
+  // channels at the start
+  args.append("--flat-playlist");
+
+  // read the way the playlist tab reads them, anything that is not an
+  // option is a range of items
+  if (s.listOptions.startsWith("--")) {
+
+    args.append(util::split(s.listOptions, ' ', true));
+
+  } else if (!s.listOptions.isEmpty() &&
+             !engine.playlistItemsArgument().isEmpty()) {
+
+    args.append(engine.playlistItemsArgument());
+    args.append(util::split(s.listOptions, ' ', true));
+  }
+
+  const QString cookiePath = settings.cookieFilePath(engine.name());
+  const QString ca = engine.cookieArgument();
+
+  if (!cookiePath.isEmpty() && !ca.isEmpty()) {
+    args.append(ca);
+    args.append(cookiePath);
+  }
+
+  args.append(url);
+
+  engines::engine::exeArgs::cmd cmd(engine.exePath(), args);
+
+  util::run(cmd.exe(), cmd.args(), [this, url](const util::run_result &r) {
+    this->refreshed(url, r.success(), r.stdOut);
+  });
+}
+
+void subscriptionRefresher::refreshed(const QString &url, bool success,
+                                      const QByteArray &data) {
+  auto &st = m_state[url];
+
+  st.running = false;
+
+  m_running--;
+
+  auto now = _now();
+
+  if (success) {
+
+    QStringList urls;
+    QSet<QString> listed;
+
+    // an entry is new when it was not listed on the previous refresh,
+    // wherever the feed puts it
+    for (const auto &line : data.split('\n')) {
+
+      auto obj = QJsonDocument::fromJson(line).object();
+
+      auto id = obj.value("id").toString();
+
+      if (id.isEmpty() || listed.contains(id)) {
+
+        continue;
+      }
+
+      listed.insert(id);
+
+      if (st.seen.contains(id)) {
+
+        continue;
+      }
+
+      auto u = obj.value("webpage_url").toString();
+
+      if (u.isEmpty()) {
+
+        u = obj.value("url").toString();
+      }
+
+      if (!u.isEmpty()) {
+
+        urls.append(u);
+      }
+    }
+
+    // the first refresh of a feed only remembers what is in it
+    if (st.lastRefresh != 0 && !urls.isEmpty()) {
+
+      m_ctx.TabManager().batchDownloader().enqueue(urls, QString(), true);
+    }
+
+    // entries that left the feed are forgotten, an empty listing is more
+    // likely a hiccup than an emptied feed
+    if (!listed.isEmpty()) {
+
+      st.seen = std::move(listed);
+    }
+
+    st.lastRefresh = now;
+
+    this->save();
+  }
+
+  auto subscriptions = this->subscriptions();
+
+  auto it = subscriptions.find(url);
+
+  if (it == subscriptions.end()) {
+
+    m_state.erase(url);
+  } else {
+    // a failed refresh is retried on the next interval
+    st.due = this->nextRefresh(it->second, now);
+  }
+
+  this->schedule();
+}
+
+void subscriptionRefresher::load() {
+  QFile f(m_statePath);
+
+  if (!f.open(QIODevice::ReadOnly)) {
+
+    return;
+  }
+
+  auto obj = QJsonDocument::fromJson(f.readAll()).object();
+
+  for (auto it = obj.begin(); it != obj.end(); it++) {
+
+    auto m = it.value().toObject();
+
+    // a feed without its entries is refreshed as if it was new
+    if (!m.contains("seen")) {
+
+      continue;
+    }
+
+    auto &st = m_state[it.key()];
+
+    for (const auto &id : m.value("seen").toArray()) {
+
+      st.seen.insert(id.toString());
+    }
+
+    st.lastRefresh = static_cast<qint64>(m.value("lastRefresh").toDouble());
+  }
+}
+
+void subscriptionRefresher::save() {
+  QJsonObject obj;
+
+  for (const auto &it : m_state) {
+
+    if (it.second.lastRefresh == 0) {
+
+      continue;
+    }
+
+    QJsonObject m;
+
+    QJsonArray seen;
+
+    for (const auto &id : it.second.seen) {
+
+      seen.append(id);
+    }
+
+    m.insert("seen", seen);
+    m.insert("lastRefresh", static_cast<double>(it.second.lastRefresh));
+
+    obj.insert(it.first, m);
+  }
+
+  QSaveFile f(m_statePath);
+
+  if (f.open(QIODevice::WriteOnly)) {
+
+    f.write(QJsonDocument(obj).toJson(QJsonDocument::Indented));
+
+    f.commit();
+  }
+}
@@ -0,0 +1,77 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef SUBSCRIPTIONREFRESHER_H
+#define SUBSCRIPTIONREFRESHER_H
+
+#include <QByteArray>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+
+#include <map>
+
+class Context;
+
+/*
+ * Refreshes the subscriptions in subscriptions.json in the background.
+ *
+ * Every subscription is listed on its own interval with some jitter and
+ * the entries that were not listed on the previous refresh are added to the
+ * batch downloader, this works for channels and for playlists that add new
+ * entries at the end. A feed with an interval of 0 is not refreshed. The
+ * entries of every feed are kept in subscriptions_state.json.
+ */
+class subscriptionRefresher {
+public:
+  subscriptionRefresher(const Context &);
+  void start();
+
+private:
+  struct subscription {
+    QString url;
+    QString listOptions;
+    qint64 interval;
+  };
+  struct state {
+    QSet<QString> seen;
+    qint64 lastRefresh = 0;
+    qint64 due = 0;
+    bool running = false;
+  };
+  std::map<QString, subscription> subscriptions();
+  void schedule();
+  void refreshDue();
+  void refresh(const subscription &);
+  void refreshed(const QString &url, bool success, const QByteArray &data);
+  qint64 nextRefresh(const subscription &, qint64 lastRefresh);
+  void load();
+  void save();
+  const Context &m_ctx;
+  QString m_subscriptionsPath;
+  QString m_statePath;
+  QTimer m_timer;
+  std::map<QString, state> m_state;
+  size_t m_running = 0;
+};
+
+#endif
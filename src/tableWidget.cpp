@@ -22,10 +22,16 @@
 
 #include "tableWidget.h"
 #include "downloadmanager.h"
+#include "thumbnailcache.h"
 #include "utility.h"
 
+#include <QApplication>
 #include <QBuffer>
 #include <QHeaderView>
+#include <QPainter>
+
+#include <algorithm>
+#include <iterator>
 
 QString tableWidget::thumbnailData(int row) const {
   const auto &s = m_items[static_cast<size_t>(row)];
@@ -34,7 +40,7 @@ QString tableWidget::thumbnailData(int row) const {
 
     QBuffer buffer;
 
-    s.thumbnail.image.save(&buffer, "PNG");
+    s.thumbnail.load().save(&buffer, "PNG");
 
     return buffer.buffer().toHex();
   } else {
@@ -42,6 +48,44 @@ QString tableWidget::thumbnailData(int row) const {
   }
 }
 
+QPixmap
+tableWidget::entry::tnail::pixmap(std::function<void()> loaded) const {
+  if (!key.isEmpty()) {
+
+    auto m = thumbnailCache::instance().find(key, std::move(loaded));
+
+    if (!m.isNull()) {
+
+      return m;
+    }
+  }
+
+  return image;
+}
+
+QPixmap tableWidget::entry::tnail::load() const {
+  if (!key.isEmpty()) {
+
+    auto m = thumbnailCache::instance().get(key);
+
+    if (!m.isNull()) {
+
+      return m;
+    }
+  }
+
+  return image;
+}
+
+int tableWidget::entry::tnail::height() const {
+  if (!key.isEmpty()) {
+
+    return thumbnailCache::size(key).height();
+  }
+
+  return image.height();
+}
+
 QByteArray tableWidget::thumbnailData(const QPixmap &image) {
   QBuffer buffer;
 
@@ -134,7 +178,7 @@ void tableWidget::setDownloadingOptions(tableWidget::type type, int row,
   }
 }
 
-void tableWidget::setTableWidget(QTableWidget &table,
+void tableWidget::setTableWidget(QTableView &table,
                                  const tableWidget::tableWidgetOptions &s) {
   table.verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
@@ -156,59 +200,63 @@ void tableWidget::replace(tableWidget::entry e, int r) {
 
   m_items[row] = std::move(e);
 
-  auto thumbnailLabel = new QLabel();
+  this->fitRowHeight(m_items[row]);
 
-  thumbnailLabel->setAlignment(Qt::AlignCenter);
+  m_model.changed(r, r);
 
-  thumbnailLabel->setPixmap(m_items[row].thumbnail.image);
-
-  m_table.setCellWidget(r, 0, thumbnailLabel);
-
-  m_table.item(r, 1)->setText(m_items[row].uiText);
+  this->journalReplaced(r);
 }
 
-int tableWidget::addRow() {
-  auto row = m_table.rowCount();
+int tableWidget::addItem(tableWidget::entry e) {
+  auto row = this->rowCount();
 
-  m_table.insertRow(row);
+  this->fitRowHeight(e);
 
-  for (int i = 0; i < m_table.columnCount(); i++) {
+  m_model.insert(row, row, [&]() { m_items.emplace_back(std::move(e)); });
 
-    auto item = new QTableWidgetItem();
-    item->setTextAlignment(Qt::AlignCenter);
-    m_table.setItem(row, i, item);
-  }
+  this->journalAdded(row, row);
 
   return row;
 }
 
-int tableWidget::addItem(tableWidget::entry e) {
+int tableWidget::addItems(std::vector<tableWidget::entry> entries) {
+  auto first = this->rowCount();
 
-  m_items.emplace_back(std::move(e));
+  if (entries.empty()) {
 
-  const auto &entry = m_items.back();
+    return first;
+  }
 
-  auto row = m_table.rowCount();
+  auto last = first + static_cast<int>(entries.size()) - 1;
 
-  m_table.insertRow(row);
+  for (const auto &it : entries) {
 
-  auto thumbnailLabel = new QLabel();
+    this->fitRowHeight(it);
+  }
 
-  thumbnailLabel->setAlignment(Qt::AlignHCenter | Qt::AlignVCenter);
+  m_model.insert(first, last, [&]() {
+    std::move(entries.begin(), entries.end(), std::back_inserter(m_items));
+  });
 
-  thumbnailLabel->setPixmap(entry.thumbnail.image);
+  this->journalAdded(first, last);
 
-  m_table.setCellWidget(row, 0, thumbnailLabel);
+  return first;
+}
+
+void tableWidget::reset(std::vector<tableWidget::entry> entries) {
+  for (const auto &it : entries) {
 
-  auto item = new QTableWidgetItem(entry.uiText);
+    this->fitRowHeight(it);
+  }
 
-  item->setTextAlignment(entry.alignment);
+  m_model.reset([&]() { m_items = std::move(entries); });
 
-  m_table.setItem(row, 1, item);
+  if (m_journal) {
 
-  m_table.resizeRowsToContents();
+    m_journal->cleared();
 
-  return row;
+    this->journalAdded(0, this->rowCount() - 1);
+  }
 }
 
 void tableWidget::selectRow(QTableWidgetItem *current,
@@ -248,43 +296,90 @@ void tableWidget::selectRow(QTableWidgetItem *current,
 }
 
 void tableWidget::clear() {
-  int m = m_table.rowCount();
+  m_model.reset([this]() { m_items.clear(); });
 
-  for (int i = 0; i < m; i++) {
+  if (m_journal) {
 
-    m_table.removeRow(0);
+    m_journal->cleared();
   }
-
-  m_items.clear();
 }
 
 void tableWidget::setVisible(bool e) { m_table.setVisible(e); }
 
-int tableWidget::rowCount() const { return m_table.rowCount(); }
+int tableWidget::rowCount() const { return static_cast<int>(m_items.size()); }
 
 void tableWidget::selectLast() {
-  if (m_table.rowCount() > 0) {
+  auto rows = this->rowCount();
+
+  if (rows > 0) {
 
-    m_table.setCurrentCell(m_table.rowCount() - 1, m_table.columnCount() - 1);
+    m_table.setCurrentIndex(m_model.index(rows - 1, m_init));
     m_table.scrollToBottom();
   }
 }
 
 void tableWidget::setEnabled(bool e) { m_table.setEnabled(e); }
 
-int tableWidget::currentRow() const { return m_table.currentRow(); }
+int tableWidget::currentRow() const { return m_table.currentIndex().row(); }
 
 void tableWidget::removeRow(int s) {
-  m_table.removeRow(s);
-  m_items.erase(m_items.begin() + s);
+  m_model.remove(s, [&]() { m_items.erase(m_items.begin() + s); });
+
+  if (m_journal) {
+
+    m_journal->removed(s);
+  }
+}
+
+void tableWidget::journalReplaced(int row) {
+  if (m_journal) {
+
+    m_journal->replaced(row, this->journalRecord(row));
+  }
+}
+
+void tableWidget::journalAdded(int first, int last) {
+  if (m_journal) {
+
+    for (int row = first; row <= last; row++) {
+
+      m_journal->added(this->journalRecord(row));
+    }
+  }
+}
+
+void tableWidget::fitRowHeight(const tableWidget::entry &e) {
+  auto &header = *m_table.verticalHeader();
+
+  auto lines = e.uiText.count('\n') + 1;
+  auto textHeight = lines * m_table.fontMetrics().lineSpacing();
+
+  auto height = std::max(e.thumbnail.height(), textHeight) + 4;
+
+  // all rows share the height of the tallest row seen so far
+  if (height > header.defaultSectionSize()) {
+
+    header.setDefaultSectionSize(height);
+  }
+}
+
+tableJournal::record tableWidget::journalRecord(int row) const {
+  const auto &e = this->item(row);
+
+  return {e.url,
+          e.uiText,
+          e.runningState,
+          e.downloadingOptions,
+          e.downloadingOptionsUi,
+          e.engineName};
 }
 
 bool tableWidget::isSelected(int row) {
-  return m_table.item(row, m_init)->isSelected();
+  return m_table.selectionModel()->isRowSelected(row, QModelIndex());
 }
 
 bool tableWidget::noneAreRunning() {
-  for (int i = 0; i < m_table.rowCount(); i++) {
+  for (int i = 0; i < this->rowCount(); i++) {
 
     if (downloadManager::finishedStatus::running(this->runningState(i))) {
 
@@ -301,7 +396,7 @@ QString tableWidget::completeProgress(int) {
   int cancelled = 0;
   int notStarted = 0;
 
-  for (int i = 0; i < m_table.rowCount(); i++) {
+  for (int i = 0; i < this->rowCount(); i++) {
 
     const auto &s = this->runningState(i);
 
@@ -324,7 +419,7 @@ QString tableWidget::completeProgress(int) {
   }
 
   auto a = QString::number((completed + errored + cancelled) * 100 /
-                           m_table.rowCount());
+                           this->rowCount());
   auto b = QString::number(notStarted);
   auto c = QString::number(completed);
   auto d = QString::number(errored);
@@ -341,13 +436,123 @@ QString tableWidget::completeProgress(int) {
              .arg(a, b, c, d, e);
 }
 
-tableWidget::tableWidget(QTableWidget &t, const QFont &, int init)
-    : m_table(t), m_init(init) {
+tableWidget::tableWidget(QTableView &t, const QFont &, int init)
+    : m_table(t), m_init(init), m_model(m_items) {
   this->setTableWidget(m_table, tableWidget::tableWidgetOptions());
+
+  m_table.setModel(&m_model);
+  m_table.setItemDelegate(&m_delegate);
+
+  m_table.setSelectionBehavior(QAbstractItemView::SelectRows);
+  m_table.setSelectionMode(QAbstractItemView::SingleSelection);
+
+  // rows are never measured, they all get the default section size
+  auto &header = *m_table.verticalHeader();
+
+  header.setSectionResizeMode(QHeaderView::Fixed);
+  header.setDefaultSectionSize(header.minimumSectionSize());
 }
 
-QTableWidgetItem &tableWidget::item(int row, int column) const {
-  return *m_table.item(row, column);
+QTableView &tableWidget::get() { return m_table; }
+
+int tableWidget::model::rowCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+
+    return 0;
+  }
+
+  return static_cast<int>(m_items.size());
+}
+
+int tableWidget::model::columnCount(const QModelIndex &parent) const {
+  if (parent.isValid()) {
+
+    return 0;
+  }
+
+  return 2;
 }
 
-QTableWidget &tableWidget::get() { return m_table; }
+QVariant tableWidget::model::data(const QModelIndex &index, int role) const {
+  auto row = index.row();
+
+  if (!index.isValid() || row >= this->rowCount()) {
+
+    return {};
+  }
+
+  const auto &e = m_items[static_cast<size_t>(row)];
+
+  if (index.column() == 0) {
+
+    if (role == Qt::DecorationRole) {
+
+      auto m = const_cast<tableWidget::model *>(this);
+
+      // rows are painted again once a thumbnail read from disk is in memory
+      return e.thumbnail.pixmap([m]() {
+        if (m->rowCount() > 0) {
+
+          m->changed(0, m->rowCount() - 1);
+        }
+      });
+    }
+
+  } else if (role == Qt::DisplayRole) {
+
+    return e.uiText;
+
+  } else if (role == Qt::TextAlignmentRole) {
+
+    return e.alignment;
+  }
+
+  return {};
+}
+
+QVariant tableWidget::model::headerData(int section,
+                                        Qt::Orientation orientation,
+                                        int role) const {
+  if (orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+
+    if (section == 0) {
+
+      return QObject::tr("Preview");
+    } else {
+      return QObject::tr("Items");
+    }
+  }
+
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+void tableWidget::delegate::paint(QPainter *painter,
+                                  const QStyleOptionViewItem &option,
+                                  const QModelIndex &index) const {
+  if (index.column() != 0) {
+
+    QStyledItemDelegate::paint(painter, option, index);
+
+    return;
+  }
+
+  QStyleOptionViewItem opt = option;
+
+  // only the text of a selected row is highlighted
+  opt.state &= ~QStyle::State_Selected;
+
+  auto style = opt.widget ? opt.widget->style() : QApplication::style();
+
+  style->drawControl(QStyle::CE_ItemViewItem, &opt, painter, opt.widget);
+
+  auto pixmap = index.data(Qt::DecorationRole).value<QPixmap>();
+
+  if (!pixmap.isNull()) {
+
+    QRect rect(QPoint(), pixmap.size() / pixmap.devicePixelRatio());
+
+    rect.moveCenter(opt.rect.center());
+
+    painter->drawPixmap(rect, pixmap);
+  }
+}
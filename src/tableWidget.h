@@ -23,13 +23,18 @@
 #ifndef TABLEWIDGET_H
 #define TABLEWIDGET_H
 
+#include <QAbstractTableModel>
 #include <QLabel>
 #include <QLineEdit>
 #include <QObject>
+#include <QStyledItemDelegate>
+#include <QTableView>
 #include <QTableWidget>
 
 #include "engines.h"
+#include "tablejournal.h"
 
+#include <functional>
 #include <vector>
 
 class tableWidget {
@@ -45,20 +50,33 @@ public:
   };
   void setDownloadingOptions(const QString &s, int row) {
     this->item(row).downloadingOptions = s;
+    this->journalReplaced(row);
   }
   void setDownloadingOptionsUi(const QString &s, int row) {
     this->item(row).downloadingOptionsUi = s;
   }
   void setEngineName(const QString &s, int row) {
     this->item(row).engineName = s;
+    this->journalReplaced(row);
   }
   void setUiText(const QString &s, int row) {
     this->item(row).uiText = s;
-    m_table.item(row, 1)->setText(s);
+    this->fitRowHeight(this->item(row));
+    m_model.changed(row, row);
   }
   void setRunningState(const QString &s, int row) {
     this->item(row).runningState = s;
+
+    if (m_journal) {
+
+      m_journal->stateChanged(row, s);
+    }
   }
+  /*
+   * Mirrors every change made to the rows in "journal", the journal must
+   * describe the same rows as the table when it is set.
+   */
+  void setJournal(tableJournal *journal) { m_journal = journal; }
   const QString &downloadingOptions(int row) const {
     return this->item(row).downloadingOptions;
   }
@@ -70,12 +88,15 @@ public:
   const QString &engineName(int row) const {
     return this->item(row).engineName;
   }
-  const QPixmap &thumbnail(int row) const {
-    return this->item(row).thumbnail.image;
+  QPixmap thumbnail(int row) const {
+    return this->item(row).thumbnail.load();
   }
   const QString &runningState(int row) const {
     return this->item(row).runningState;
   }
+  const QString &archiveId(int row) const {
+    return this->item(row).archiveId;
+  }
   int startPosition() const { return m_init; }
   template <typename... T> void hideColumns(T... t) {
     for (auto it : {t...}) {
@@ -97,14 +118,71 @@ public:
     QString downloadingOptions;
     QString downloadingOptionsUi;
     QString engineName;
+    QString archiveId;
     struct tnail {
       tnail(const QPixmap &p) : isSet(true), image(p) {}
       tnail() {}
+      /*
+       * Returns the thumbnail of "key" if thumbnailCache has it in memory,
+       * "image" is used otherwise. A thumbnail that is only on disk is read
+       * in the background and "loaded" is called once it can be returned.
+       */
+      QPixmap pixmap(std::function<void()> loaded) const;
+      // like pixmap() but reads a thumbnail that is only on disk right away
+      QPixmap load() const;
+      // the height of the thumbnail without loading it
+      int height() const;
       bool isSet = false;
       QPixmap image;
+      QString key;
     } thumbnail;
     int alignment = Qt::AlignCenter;
   };
+  /*
+   * The rows are kept in a plain vector and the view only asks for the rows
+   * it shows, adding and removing rows costs the same no matter how many
+   * there are.
+   */
+  class model : public QAbstractTableModel {
+  public:
+    model(const std::vector<tableWidget::entry> &items) : m_items(items) {}
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &, int role) const override;
+    QVariant headerData(int section, Qt::Orientation,
+                        int role) const override;
+    template <typename Function>
+    void insert(int first, int last, Function function) {
+      this->beginInsertRows(QModelIndex(), first, last);
+      function();
+      this->endInsertRows();
+    }
+    template <typename Function> void remove(int row, Function function) {
+      this->beginRemoveRows(QModelIndex(), row, row);
+      function();
+      this->endRemoveRows();
+    }
+    template <typename Function> void reset(Function function) {
+      this->beginResetModel();
+      function();
+      this->endResetModel();
+    }
+    void changed(int first, int last) {
+      emit this->dataChanged(this->index(first, 0), this->index(last, 1));
+    }
+
+  private:
+    const std::vector<tableWidget::entry> &m_items;
+  };
+  /*
+   * Draws the thumbnail of a row at its own size, the text column is drawn
+   * by QStyledItemDelegate.
+   */
+  class delegate : public QStyledItemDelegate {
+  public:
+    void paint(QPainter *, const QStyleOptionViewItem &,
+               const QModelIndex &) const override;
+  };
   template <typename Function> void forEach(Function function) {
     for (const auto &it : m_items) {
 
@@ -115,7 +193,7 @@ public:
 
   static void selectRow(QTableWidgetItem *current, QTableWidgetItem *previous,
                         int firstColumnNumber = 0);
-  static void setTableWidget(QTableWidget &,
+  static void setTableWidget(QTableView &,
                              const tableWidget::tableWidgetOptions &);
   static QByteArray thumbnailData(const QPixmap &);
   static QString engineName();
@@ -123,8 +201,14 @@ public:
                              const QString &title = QString());
   QString thumbnailData(int row) const;
   QString completeProgress(int index);
-  int addRow();
   int addItem(tableWidget::entry);
+  /*
+   * Adds all entries with one insertion and returns the row of the first
+   * one.
+   */
+  int addItems(std::vector<tableWidget::entry>);
+  // replaces all rows of the table with "entries"
+  void reset(std::vector<tableWidget::entry> entries);
   int rowCount() const;
   int currentRow() const;
   void replace(tableWidget::entry, int row);
@@ -136,11 +220,9 @@ public:
   bool isSelected(int);
   bool noneAreRunning();
 
-  tableWidget(QTableWidget &t, const QFont &font, int init);
-
-  QTableWidgetItem &item(int row, int column) const;
+  tableWidget(QTableView &t, const QFont &font, int init);
 
-  QTableWidget &get();
+  QTableView &get();
 
   template <typename MemberFunction, typename Callback>
   void connect(MemberFunction m, Callback c) {
@@ -148,14 +230,21 @@ public:
   }
 
 private:
+  void journalReplaced(int row);
+  void journalAdded(int first, int last);
+  void fitRowHeight(const tableWidget::entry &);
+  tableJournal::record journalRecord(int row) const;
   tableWidget::entry &item(int s) { return m_items[static_cast<size_t>(s)]; }
   const tableWidget::entry &item(int s) const {
     return m_items[static_cast<size_t>(s)];
   }
-  QTableWidget &m_table;
+  QTableView &m_table;
   int m_init;
+  tableJournal *m_journal = nullptr;
 
   std::vector<tableWidget::entry> m_items;
+  tableWidget::model m_model;
+  tableWidget::delegate m_delegate;
 };
 
 template <typename Stuff> class tableMiniWidget {
@@ -0,0 +1,288 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "tablejournal.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+
+#include <algorithm>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+static void _sync(QFileDevice &file) {
+#ifdef Q_OS_WIN
+  _commit(file.handle());
+#else
+  ::fsync(file.handle());
+#endif
+}
+
+tableJournal::tableJournal(const QString &path) : m_path(path), m_file(path) {
+  m_timer.setSingleShot(true);
+  m_timer.setInterval(1000);
+
+  QObject::connect(&m_timer, &QTimer::timeout, [this]() { this->flush(); });
+}
+
+tableJournal::~tableJournal() { this->flush(); }
+
+const std::vector<tableJournal::record> &tableJournal::load() {
+  m_rows.clear();
+  m_records = 0;
+
+  QFile file(m_path);
+
+  if (!file.open(QIODevice::ReadOnly)) {
+
+    return m_rows;
+  }
+
+  const auto data = file.readAll();
+
+  file.close();
+
+  int start = 0;
+
+  auto torn = false;
+
+  while (start < data.size()) {
+
+    auto end = data.indexOf('\n', start);
+
+    if (end == -1) {
+
+      // a partially written last record is dropped
+      torn = true;
+
+      break;
+    }
+
+    auto obj = QJsonDocument::fromJson(data.mid(start, end - start)).object();
+
+    start = end + 1;
+
+    if (obj.isEmpty()) {
+
+      continue;
+    }
+
+    m_records++;
+
+    auto op = obj.value("op").toString();
+    auto row = obj.value("row").toInt(-1);
+    auto valid = row >= 0 && static_cast<size_t>(row) < m_rows.size();
+
+    if (op == "add") {
+
+      m_rows.emplace_back(tableJournal::fromJson(obj));
+
+    } else if (op == "set" && valid) {
+
+      m_rows[static_cast<size_t>(row)] = tableJournal::fromJson(obj);
+
+    } else if (op == "state" && valid) {
+
+      m_rows[static_cast<size_t>(row)].runningState =
+          obj.value("state").toString();
+
+    } else if (op == "remove" && valid) {
+
+      m_rows.erase(m_rows.begin() + row);
+    }
+  }
+
+  if (torn) {
+
+    // records appended later would otherwise continue the partial line and
+    // be lost with it on the next replay
+    this->compact();
+  }
+
+  return m_rows;
+}
+
+void tableJournal::added(tableJournal::record r) {
+  auto obj = tableJournal::toJson(r);
+
+  obj.insert("op", "add");
+
+  m_rows.emplace_back(std::move(r));
+
+  this->append(obj);
+}
+
+void tableJournal::replaced(int row, tableJournal::record r) {
+  auto obj = tableJournal::toJson(r);
+
+  obj.insert("op", "set");
+  obj.insert("row", row);
+
+  m_rows[static_cast<size_t>(row)] = std::move(r);
+
+  this->append(obj);
+}
+
+void tableJournal::stateChanged(int row, const QString &state) {
+  auto &r = m_rows[static_cast<size_t>(row)];
+
+  if (r.runningState == state) {
+
+    return;
+  }
+
+  r.runningState = state;
+
+  QJsonObject obj;
+
+  obj.insert("op", "state");
+  obj.insert("row", row);
+  obj.insert("state", state);
+
+  this->append(obj);
+}
+
+void tableJournal::removed(int row) {
+  m_rows.erase(m_rows.begin() + row);
+
+  QJsonObject obj;
+
+  obj.insert("op", "remove");
+  obj.insert("row", row);
+
+  this->append(obj);
+}
+
+void tableJournal::cleared() {
+  m_rows.clear();
+  m_pending.clear();
+  m_timer.stop();
+
+  this->compact();
+}
+
+void tableJournal::flush() {
+  m_timer.stop();
+
+  if (m_pending.isEmpty() || !this->open()) {
+
+    return;
+  }
+
+  m_file.write(m_pending);
+  m_file.flush();
+
+  _sync(m_file);
+
+  m_pending.clear();
+
+  if (m_records > std::max(size_t(1000), 4 * m_rows.size())) {
+
+    this->compact();
+  }
+}
+
+void tableJournal::append(const QJsonObject &obj) {
+  m_pending += QJsonDocument(obj).toJson(QJsonDocument::Compact);
+  m_pending += '\n';
+
+  m_records++;
+
+  if (!m_timer.isActive()) {
+
+    m_timer.start();
+  }
+}
+
+void tableJournal::compact() {
+  m_file.close();
+
+  QDir().mkpath(QFileInfo(m_path).absolutePath());
+
+  QSaveFile file(m_path);
+
+  if (!file.open(QIODevice::WriteOnly)) {
+
+    return;
+  }
+
+  for (const auto &it : m_rows) {
+
+    auto obj = tableJournal::toJson(it);
+
+    obj.insert("op", "add");
+
+    file.write(QJsonDocument(obj).toJson(QJsonDocument::Compact) + '\n');
+  }
+
+  file.flush();
+
+  _sync(file);
+
+  if (file.commit()) {
+
+    m_records = m_rows.size();
+  }
+}
+
+bool tableJournal::open() {
+  if (m_file.isOpen()) {
+
+    return true;
+  }
+
+  QDir().mkpath(QFileInfo(m_path).absolutePath());
+
+  return m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+}
+
+QJsonObject tableJournal::toJson(const tableJournal::record &r) {
+  QJsonObject obj;
+
+  obj.insert("url", r.url);
+  obj.insert("uiText", r.uiText);
+  obj.insert("runningState", r.runningState);
+  obj.insert("downloadingOptions", r.downloadingOptions);
+  obj.insert("downloadingOptionsUi", r.downloadingOptionsUi);
+  obj.insert("engineName", r.engineName);
+
+  return obj;
+}
+
+tableJournal::record tableJournal::fromJson(const QJsonObject &obj) {
+  tableJournal::record r;
+
+  r.url = obj.value("url").toString();
+  r.uiText = obj.value("uiText").toString();
+  r.runningState = obj.value("runningState").toString();
+  r.downloadingOptions = obj.value("downloadingOptions").toString();
+  r.downloadingOptionsUi = obj.value("downloadingOptionsUi").toString();
+  r.engineName = obj.value("engineName").toString();
+
+  return r;
+}
@@ -0,0 +1,81 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef TABLEJOURNAL_H
+#define TABLEJOURNAL_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QJsonObject>
+#include <QString>
+#include <QTimer>
+
+#include <vector>
+
+/*
+ * Append only journal of the changes made to a tableWidget.
+ *
+ * Every change is appended to the journal file as one json line, writes are
+ * buffered and synced to disk once a second. The journal keeps its own copy
+ * of the rows and rewrites the file as a snapshot of them once enough
+ * records have piled up.
+ */
+class tableJournal {
+public:
+  struct record {
+    QString url;
+    QString uiText;
+    QString runningState;
+    QString downloadingOptions;
+    QString downloadingOptionsUi;
+    QString engineName;
+  };
+  tableJournal(const QString &path);
+  ~tableJournal();
+  /*
+   * Replays the journal file and returns the rows it describes, the rows
+   * are kept as the starting state of the journal. A file that ends in a
+   * partially written record is rewritten without it.
+   */
+  const std::vector<tableJournal::record> &load();
+  void added(tableJournal::record);
+  void replaced(int row, tableJournal::record);
+  void stateChanged(int row, const QString &state);
+  void removed(int row);
+  void cleared();
+  void flush();
+
+private:
+  void append(const QJsonObject &);
+  void compact();
+  bool open();
+  static QJsonObject toJson(const tableJournal::record &);
+  static tableJournal::record fromJson(const QJsonObject &);
+  QString m_path;
+  QFile m_file;
+  QByteArray m_pending;
+  QTimer m_timer;
+  std::vector<tableJournal::record> m_rows;
+  size_t m_records = 0;
+};
+
+#endif
@@ -0,0 +1,313 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "thumbnailcache.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThread>
+
+#include <limits>
+
+static QString _cacheDir() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/thumbnails";
+}
+
+static QImage _decode(const QByteArray &data, const QSize &size) {
+  QBuffer buffer;
+
+  buffer.setData(data);
+  buffer.open(QIODevice::ReadOnly);
+
+  QImageReader reader(&buffer);
+
+  auto m = reader.size();
+
+  if (m.isValid()) {
+
+    // jpeg images are decoded at a fraction of their size this way
+    reader.setScaledSize(m.scaled(size, Qt::KeepAspectRatio));
+
+    return reader.read();
+  }
+
+  auto image = reader.read();
+
+  if (image.isNull()) {
+
+    return image;
+  }
+
+  return image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+}
+
+static void _post(std::function<void(const QImage &)> function,
+                  const QImage &image) {
+  auto app = QCoreApplication::instance();
+
+  if (app) {
+
+    QMetaObject::invokeMethod(
+        app, [image, function]() { function(image); }, Qt::QueuedConnection);
+  }
+}
+
+class decodeTask : public QRunnable {
+public:
+  decodeTask(const QByteArray &data, const QSize &size, const QString &path,
+             std::function<void(const QImage &)> function)
+      : m_data(data), m_size(size), m_path(path),
+        m_function(std::move(function)) {}
+  void run() override {
+    auto image = _decode(m_data, m_size);
+
+    if (!image.isNull() && !m_path.isEmpty()) {
+
+      QDir().mkpath(QFileInfo(m_path).absolutePath());
+
+      // the file only shows up under its name once it is complete, a
+      // cache lookup never sees half of it
+      QSaveFile file(m_path);
+
+      if (file.open(QIODevice::WriteOnly) && image.save(&file, "JPG", 90)) {
+
+        file.commit();
+      }
+    }
+
+    _post(std::move(m_function), image);
+  }
+
+private:
+  QByteArray m_data;
+  QSize m_size;
+  QString m_path;
+  std::function<void(const QImage &)> m_function;
+};
+
+class loadTask : public QRunnable {
+public:
+  loadTask(const QString &path, std::function<void(const QImage &)> function)
+      : m_path(path), m_function(std::move(function)) {}
+  void run() override {
+    QImage image;
+
+    image.load(m_path, "JPG");
+
+    _post(std::move(m_function), image);
+  }
+
+private:
+  QString m_path;
+  std::function<void(const QImage &)> m_function;
+};
+
+thumbnailCache &thumbnailCache::instance() {
+  static thumbnailCache cache;
+
+  return cache;
+}
+
+thumbnailCache::thumbnailCache() {
+  m_pixmaps.setMaxCost(64 * 1024 * 1024);
+
+  m_decoders.setMaxThreadCount(qMax(1, QThread::idealThreadCount() / 2));
+}
+
+QString thumbnailCache::key(const QString &url, int width, int height) {
+  return QString("%1x%2 %3").arg(QString::number(width),
+                                 QString::number(height), url);
+}
+
+void thumbnailCache::setUp(qint64 bytes, int maxAge) {
+  m_pixmaps.setMaxCost(static_cast<int>(qMin(bytes, qint64(std::numeric_limits<int>::max()))));
+
+  if (maxAge <= 0) {
+
+    return;
+  }
+
+  auto oldest = QDateTime::currentDateTime().addDays(-maxAge);
+
+  QDir dir(_cacheDir());
+
+  const auto files = dir.entryInfoList(QDir::Files);
+
+  for (const auto &it : files) {
+
+    if (it.lastModified() < oldest) {
+
+      QFile::remove(it.absoluteFilePath());
+    }
+  }
+}
+
+bool thumbnailCache::contains(const QString &key) const {
+  return m_pixmaps.contains(key) || QFile::exists(thumbnailCache::path(key));
+}
+
+QSize thumbnailCache::size(const QString &key) {
+  auto m = key.section(' ', 0, 0).split('x');
+
+  if (m.size() == 2) {
+
+    return {m[0].toInt(), m[1].toInt()};
+  }
+
+  return {};
+}
+
+QPixmap thumbnailCache::find(const QString &key,
+                             std::function<void()> loaded) {
+  auto m = m_pixmaps.object(key);
+
+  if (m) {
+
+    return *m;
+  }
+
+  auto it = m_loading.find(key);
+
+  if (it != m_loading.end()) {
+
+    it->second.emplace_back(std::move(loaded));
+
+    return {};
+  }
+
+  m_loading[key].emplace_back(std::move(loaded));
+
+  auto done = [this, key](const QImage &image) {
+    if (!image.isNull()) {
+
+      this->insert(key, QPixmap::fromImage(image));
+    }
+
+    auto functions = std::move(m_loading[key]);
+
+    m_loading.erase(key);
+
+    if (image.isNull()) {
+
+      return;
+    }
+
+    for (const auto &it : functions) {
+
+      if (it) {
+
+        it();
+      }
+    }
+  };
+
+  m_decoders.start(new loadTask(thumbnailCache::path(key), std::move(done)));
+
+  return {};
+}
+
+QPixmap thumbnailCache::get(const QString &key) {
+  auto m = m_pixmaps.object(key);
+
+  if (m) {
+
+    return *m;
+  }
+
+  QPixmap pixmap;
+
+  if (pixmap.load(thumbnailCache::path(key), "JPG")) {
+
+    this->insert(key, pixmap);
+  }
+
+  return pixmap;
+}
+
+void thumbnailCache::add(const QString &key, const QByteArray &data,
+                         int width, int height,
+                         std::function<void(bool)> function) {
+  auto it = m_adding.find(key);
+
+  if (it != m_adding.end()) {
+
+    // the thumbnail is already being decoded and saved
+    it->second.emplace_back(std::move(function));
+
+    return;
+  }
+
+  m_adding[key].emplace_back(std::move(function));
+
+  auto path = thumbnailCache::path(key);
+
+  auto done = [this, key](const QImage &m) {
+    if (!m.isNull()) {
+
+      this->insert(key, QPixmap::fromImage(m));
+    }
+
+    auto functions = std::move(m_adding[key]);
+
+    m_adding.erase(key);
+
+    for (const auto &it : functions) {
+
+      it(!m.isNull());
+    }
+  };
+
+  this->decode(data, QSize(width, height), path, std::move(done));
+}
+
+void thumbnailCache::decode(const QByteArray &data, const QSize &size,
+                            std::function<void(const QImage &)> function) {
+  this->decode(data, size, QString(), std::move(function));
+}
+
+void thumbnailCache::decode(const QByteArray &data, const QSize &size,
+                            const QString &path,
+                            std::function<void(const QImage &)> function) {
+  m_decoders.start(new decodeTask(data, size, path, std::move(function)));
+}
+
+void thumbnailCache::insert(const QString &key, const QPixmap &pixmap) {
+  auto cost = pixmap.width() * pixmap.height() * pixmap.depth() / 8;
+
+  m_pixmaps.insert(key, new QPixmap(pixmap), qMax(cost, 1));
+}
+
+QString thumbnailCache::path(const QString &key) {
+  auto m = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1);
+
+  return _cacheDir() + "/" + m.toHex() + ".jpg";
+}
@@ -0,0 +1,98 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef THUMBNAILCACHE_H
+#define THUMBNAILCACHE_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QImage>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+#include <functional>
+#include <map>
+#include <vector>
+
+/*
+ * Thumbnails shared by all tables, keyed by thumbnail url and size.
+ *
+ * Thumbnails are kept already scaled, the most recently used ones in memory
+ * up to a byte budget and all of them on disk as small jpeg files so they
+ * are not downloaded and scaled again when a list is reloaded. Table rows
+ * only hold the key of their thumbnail.
+ *
+ * Downloaded images are decoded on a small pool of worker threads straight
+ * to the size they are shown at, only the finished image is handed to the
+ * ui thread.
+ */
+class thumbnailCache {
+public:
+  static thumbnailCache &instance();
+  static QString key(const QString &url, int width, int height);
+  // "bytes" is the memory budget, files older than "maxAge" days are removed
+  void setUp(qint64 bytes, int maxAge);
+  bool contains(const QString &key) const;
+  // the size the thumbnail of "key" was scaled to fit
+  static QSize size(const QString &key);
+  /*
+   * Returns the thumbnail of "key" from memory or from disk, a null pixmap
+   * is returned if it is in neither.
+   */
+  QPixmap get(const QString &key);
+  /*
+   * Returns the thumbnail of "key" if it is in memory. Otherwise a null
+   * pixmap is returned and the thumbnail is read from disk on a worker
+   * thread, "loaded" is called on the ui thread once it is in memory.
+   */
+  QPixmap find(const QString &key, std::function<void()> loaded);
+  /*
+   * Decodes "data" to fit "width" by "height" and keeps it under "key".
+   * "function" is called on the ui thread with false if "data" is not an
+   * image.
+   */
+  void add(const QString &key, const QByteArray &data, int width, int height,
+           std::function<void(bool)> function);
+  /*
+   * Decodes "data" to fit "size" on a worker thread, "function" is called
+   * on the ui thread with a null image if "data" is not an image.
+   */
+  void decode(const QByteArray &data, const QSize &size,
+              std::function<void(const QImage &)> function);
+
+private:
+  thumbnailCache();
+  void decode(const QByteArray &data, const QSize &size, const QString &path,
+              std::function<void(const QImage &)> function);
+  void insert(const QString &key, const QPixmap &);
+  static QString path(const QString &key);
+  QCache<QString, QPixmap> m_pixmaps;
+  QThreadPool m_decoders;
+  // callers of add() waiting on a key that is being decoded
+  std::map<QString, std::vector<std::function<void(bool)>>> m_adding;
+  // callers of find() waiting on a key that is being read from disk
+  std::map<QString, std::vector<std::function<void()>>> m_loading;
+};
+
+#endif
@@ -0,0 +1,352 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#include "thumbnailfetcher.h"
+#include "networkAccess.h"
+#include "settings.h"
+#include "tableWidget.h"
+
+#include <QUrl>
+
+#include <algorithm>
+#include <iterator>
+
+static bool _pop(std::deque<QString> &queue, QString &url) {
+  if (queue.empty()) {
+
+    return false;
+  }
+
+  url = std::move(queue.front());
+
+  queue.pop_front();
+
+  return true;
+}
+
+static bool _visible(tableWidget &table, const QString &rowUrl) {
+  auto &view = table.get();
+
+  auto first = view.rowAt(0);
+
+  if (first == -1) {
+
+    return false;
+  }
+
+  auto last = view.rowAt(view.viewport()->height() - 1);
+
+  if (last == -1) {
+
+    last = table.rowCount() - 1;
+  }
+
+  for (int row = first; row <= last; row++) {
+
+    if (table.url(row) == rowUrl) {
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+thumbnailFetcher::thumbnailFetcher(QNetworkAccessManager &m, settings &s)
+    : m_manager(m), m_maxPerHost(s.thumbnailFetchesPerHost()) {}
+
+void thumbnailFetcher::fetch(
+    tableWidget &table, const QString &rowUrl, const QString &url,
+    std::function<void(const QByteArray &, bool)> function) {
+  auto it = m_requests.find(url);
+
+  if (it == m_requests.end()) {
+
+    it = m_requests.emplace(url, thumbnailFetcher::request()).first;
+
+    it->second.host = QUrl(url).host();
+  }
+
+  auto &r = it->second;
+
+  r.waiters.push_back({&table, rowUrl, std::move(function)});
+
+  m_rows[&table].emplace(rowUrl, url);
+
+  if (!r.reply) {
+
+    auto &h = m_hosts[r.host];
+
+    if (_visible(table, rowUrl)) {
+
+      h.visible.push_back(url);
+    } else {
+      h.queued.push_back(url);
+    }
+
+    this->dispatch(r.host);
+  }
+}
+
+void thumbnailFetcher::prioritise(tableWidget &table) {
+  auto rows = m_rows.find(&table);
+
+  if (rows == m_rows.end()) {
+
+    return;
+  }
+
+  auto &view = table.get();
+
+  auto first = view.rowAt(0);
+
+  if (first == -1) {
+
+    return;
+  }
+
+  auto last = view.rowAt(view.viewport()->height() - 1);
+
+  if (last == -1) {
+
+    last = table.rowCount() - 1;
+  }
+
+  for (int row = first; row <= last; row++) {
+
+    auto range = rows->second.equal_range(table.url(row));
+
+    for (auto it = range.first; it != range.second; it++) {
+
+      auto m = m_requests.find(it->second);
+
+      if (m == m_requests.end() || m->second.reply) {
+
+        continue;
+      }
+
+      auto &visible = m_hosts[m->second.host].visible;
+
+      // the entry left in "queued" is skipped once the request started
+      if (std::find(visible.begin(), visible.end(), it->second) ==
+          visible.end()) {
+
+        visible.push_back(it->second);
+      }
+    }
+  }
+}
+
+void thumbnailFetcher::cancel(tableWidget &table, const QString &rowUrl) {
+  auto rows = m_rows.find(&table);
+
+  if (rows == m_rows.end()) {
+
+    return;
+  }
+
+  std::vector<QString> urls;
+
+  auto range = rows->second.equal_range(rowUrl);
+
+  for (auto it = range.first; it != range.second; it++) {
+
+    urls.emplace_back(it->second);
+  }
+
+  rows->second.erase(range.first, range.second);
+
+  std::vector<thumbnailFetcher::waiter> dropped;
+
+  for (const auto &it : urls) {
+
+    this->drop(&table, rowUrl, it, dropped);
+  }
+
+  for (const auto &it : dropped) {
+
+    it.function(QByteArray(), true);
+  }
+}
+
+void thumbnailFetcher::cancel(tableWidget &table) {
+  auto rows = m_rows.find(&table);
+
+  if (rows == m_rows.end()) {
+
+    return;
+  }
+
+  auto m = std::move(rows->second);
+
+  m_rows.erase(rows);
+
+  std::vector<thumbnailFetcher::waiter> dropped;
+
+  for (const auto &it : m) {
+
+    this->drop(&table, it.first, it.second, dropped);
+  }
+
+  for (const auto &it : dropped) {
+
+    it.function(QByteArray(), true);
+  }
+}
+
+void thumbnailFetcher::dispatch(const QString &hostName) {
+  auto &h = m_hosts[hostName];
+
+  QString url;
+
+  while (h.running < m_maxPerHost &&
+         (_pop(h.visible, url) || _pop(h.queued, url))) {
+
+    auto it = m_requests.find(url);
+
+    // cancelled or already started
+    if (it != m_requests.end() && !it->second.reply) {
+
+      this->start(url, it->second);
+    }
+  }
+
+  if (h.running == 0 && h.visible.empty() && h.queued.empty()) {
+
+    m_hosts.erase(hostName);
+  }
+}
+
+void thumbnailFetcher::start(const QString &url, thumbnailFetcher::request &r) {
+  auto reply = m_manager.get(networkAccess::networkRequest(url));
+
+  r.reply = reply;
+
+  m_hosts[r.host].running++;
+
+  auto host = r.host;
+
+  QObject::connect(reply, &QNetworkReply::finished, [this, reply, url, host]() {
+    this->finished(reply, url, host);
+  });
+}
+
+void thumbnailFetcher::finished(QNetworkReply *reply, const QString &url,
+                                const QString &host) {
+  reply->deleteLater();
+
+  m_hosts[host].running--;
+
+  auto it = m_requests.find(url);
+
+  // an aborted request was removed when it was cancelled
+  if (it != m_requests.end() && it->second.reply == reply) {
+
+    auto waiters = std::move(it->second.waiters);
+
+    m_requests.erase(it);
+
+    QByteArray data;
+
+    if (reply->error() == QNetworkReply::NoError) {
+
+      data = reply->readAll();
+    }
+
+    for (const auto &m : waiters) {
+
+      this->forget(m.table, m.rowUrl, url);
+    }
+
+    for (const auto &m : waiters) {
+
+      m.function(data, false);
+    }
+  }
+
+  this->dispatch(host);
+}
+
+void thumbnailFetcher::drop(const tableWidget *table, const QString &rowUrl,
+                            const QString &url,
+                            std::vector<thumbnailFetcher::waiter> &dropped) {
+  auto it = m_requests.find(url);
+
+  if (it == m_requests.end()) {
+
+    return;
+  }
+
+  auto &waiters = it->second.waiters;
+
+  auto m = std::stable_partition(
+      waiters.begin(), waiters.end(), [&](const waiter &w) {
+        return w.table != table || w.rowUrl != rowUrl;
+      });
+
+  // they are told after the fetcher is consistent again, they may fetch
+  std::move(m, waiters.end(), std::back_inserter(dropped));
+
+  waiters.erase(m, waiters.end());
+
+  if (!waiters.empty()) {
+
+    return;
+  }
+
+  auto reply = it->second.reply;
+
+  // queue entries of the request are skipped once it is gone
+  m_requests.erase(it);
+
+  if (reply) {
+
+    reply->abort();
+  }
+}
+
+void thumbnailFetcher::forget(const tableWidget *table, const QString &rowUrl,
+                              const QString &url) {
+  auto rows = m_rows.find(table);
+
+  if (rows == m_rows.end()) {
+
+    return;
+  }
+
+  auto range = rows->second.equal_range(rowUrl);
+
+  for (auto it = range.first; it != range.second; it++) {
+
+    if (it->second == url) {
+
+      rows->second.erase(it);
+
+      break;
+    }
+  }
+
+  if (rows->second.empty()) {
+
+    m_rows.erase(rows);
+  }
+}
@@ -0,0 +1,94 @@
+/*
+ *  Copyright (c) 2021 Keshav Bhatt
+ *
+ *  Permission is hereby granted, free of charge, to any person obtaining a copy
+ *  of this software and associated documentation files (the "Software"), to
+ * deal in the Software without restriction, including without limitation the
+ * rights to use, copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom the Software is
+ *  furnished to do so, subject to the following conditions:
+ *
+ *  The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ *  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ *  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ * IN THE SOFTWARE.
+ */
+
+#ifndef THUMBNAILFETCHER_H
+#define THUMBNAILFETCHER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <vector>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class settings;
+class tableWidget;
+
+/*
+ * Downloads the thumbnails of table rows.
+ *
+ * Requests for a url that is already being fetched wait on the same
+ * download, at most "ThumbnailFetchesPerHost" downloads run against a host
+ * and requests for rows that are visible in their table are started before
+ * the others. Requests are made on behalf of a row, identified by its url,
+ * and are cancelled when the row is removed.
+ */
+class thumbnailFetcher {
+public:
+  thumbnailFetcher(QNetworkAccessManager &, settings &);
+  /*
+   * Fetches "url" for the row of "table" whose url is "rowUrl", "function"
+   * is called with the downloaded data or with an empty QByteArray on
+   * failure. It is also called, with "cancelled" set, when the request is
+   * cancelled.
+   */
+  void fetch(tableWidget &table, const QString &rowUrl, const QString &url,
+             std::function<void(const QByteArray &, bool cancelled)> function);
+  // moves requests of the rows "table" currently shows to the front
+  void prioritise(tableWidget &table);
+  void cancel(tableWidget &table, const QString &rowUrl);
+  void cancel(tableWidget &table);
+
+private:
+  struct waiter {
+    const tableWidget *table;
+    QString rowUrl;
+    std::function<void(const QByteArray &, bool)> function;
+  };
+  struct request {
+    QString host;
+    std::vector<waiter> waiters;
+    QNetworkReply *reply = nullptr;
+  };
+  struct host {
+    std::deque<QString> visible;
+    std::deque<QString> queued;
+    int running = 0;
+  };
+  void dispatch(const QString &host);
+  void start(const QString &url, thumbnailFetcher::request &);
+  void finished(QNetworkReply *, const QString &url, const QString &host);
+  void drop(const tableWidget *, const QString &rowUrl, const QString &url,
+            std::vector<thumbnailFetcher::waiter> &dropped);
+  void forget(const tableWidget *, const QString &rowUrl, const QString &url);
+  QNetworkAccessManager &m_manager;
+  int m_maxPerHost;
+  std::map<QString, thumbnailFetcher::request> m_requests;
+  std::map<QString, thumbnailFetcher::host> m_hosts;
+  // the urls rows of every table are waiting on, keyed by row url
+  std::map<const tableWidget *, std::multimap<QString, QString>> m_rows;
+};
+
+#endif
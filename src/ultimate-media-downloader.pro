@@ -62,6 +62,7 @@ LIBS += -lgumbo
 SOURCES += \
     about/about.cpp \
     accountmanager.cpp \
+    archiveindex.cpp \
     basicdownloader.cpp \
     batchdownloader.cpp \
     configure.cpp \
@@ -86,10 +87,15 @@ SOURCES += \
     translator.cpp \
     mainwindow.cpp \
     playlistdownloader.cpp \
+    rpcserver.cpp \
     library.cpp \
     tableWidget.cpp \
+    tablejournal.cpp \
     settings.cpp \
+    subscriptionrefresher.cpp \
     tabmanager.cpp \
+    thumbnailcache.cpp \
+    thumbnailfetcher.cpp \
     trendingwidget.cpp \
     utility.cpp \
     logwindow.cpp \
@@ -111,6 +117,7 @@ SOURCES += \
 HEADERS += \
     about/about.h \
     accountmanager.h \
+    archiveindex.h \
     basicdownloader.h \
     batchdownloader.h \
     configure.h \
@@ -126,6 +133,7 @@ HEADERS += \
     mainwindow.h \
     networkAccess.h \
     playlistdownloader.h \
+    rpcserver.h \
     services/invidiousinstances.h \
     services/invidioustrendingparser.h \
     services/playerservice.h \
@@ -136,9 +144,13 @@ HEADERS += \
     services/ytdlgetformat.h \
     services/ytsearchservice.h \
     settings.h \
+    subscriptionrefresher.h \
     supportedsites.h \
     tableWidget.h \
+    tablejournal.h \
     tabmanager.h \
+    thumbnailcache.h \
+    thumbnailfetcher.h \
     translator.h \
     trendingwidget.h \
     utility.h \
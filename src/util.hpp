@@ -29,6 +29,7 @@
 #include <QTimer>
 #include <QFile>
 #include <QApplication>
+#include <QPointer>
 
 #include <QtNetwork/QLocalServer>
 #include <QtNetwork/QLocalSocket>
@@ -883,15 +884,70 @@ private:
 
 			auto s = m_localServer.nextPendingConnection() ;
 
-			QObject::connect( s,&QLocalSocket::readyRead,[ this,s ]{
+			auto buffer = std::make_shared< QByteArray >() ;
+
+			QObject::connect( s,&QLocalSocket::readyRead,[ this,s,buffer ]{
+
+				*buffer += s->readAll() ;
+
+				this->requests( *buffer,s ) ;
+			} ) ;
+
+			QObject::connect( s,&QLocalSocket::disconnected,[ this,s,buffer ]{
+
+				*buffer += s->readAll() ;
+
+				if( !buffer->trimmed().isEmpty() ){
+
+					m_mainApp->event( *buffer ) ;
+				}
 
-				m_mainApp->event( s->readAll() ) ;
 				s->deleteLater() ;
 			} ) ;
 		} ) ;
 
 		m_localServer.listen( m_serverPath ) ;
 	}
+	/*
+	 * Lines that start with a json-rpc object are requests and are answered
+	 * on the same connection, anything else is passed to the main app as
+	 * one event when the client disconnects.
+	 */
+	void requests( QByteArray& buffer,QLocalSocket * s )
+	{
+		while( true ){
+
+			auto m = buffer.indexOf( '\n' ) ;
+
+			if( m == -1 ){
+
+				break ;
+			}
+
+			auto line = buffer.mid( 0,m ).trimmed() ;
+
+			if( !line.startsWith( '{' ) || !line.contains( "\"jsonrpc\"" ) ){
+
+				break ;
+			}
+
+			buffer.remove( 0,m + 1 ) ;
+
+			QPointer< QLocalSocket > socket( s ) ;
+
+			m_mainApp->request( line,[ socket ]( const QByteArray& e ){
+
+				if( socket && socket->state() == QLocalSocket::ConnectedState ){
+
+					socket->write( e + "\n" ) ;
+
+					return true ;
+				}else{
+					return false ;
+				}
+			} ) ;
+		}
+	}
 	QLocalServer m_localServer ;
 	QLocalSocket m_localSocket ;
 	QString m_serverPath ;
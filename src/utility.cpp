@@ -31,9 +31,11 @@
 #include "tabmanager.h"
 
 #include <QClipboard>
+#include <QCryptographicHash>
 #include <QDesktopServices>
 #include <QEventLoop>
 #include <QFileDialog>
+#include <QFileInfo>
 #include <QMessageBox>
 #include <QMimeData>
 #include <QSysInfo>
@@ -362,7 +364,14 @@ QStringList utility::updateOptions(const updateOptionsStruct &s) {
   engine.updateDownLoadCmdOptions(
       {args.quality(), args.otherOptions(), indexAsString, url, opts});
 
-  opts.append(url);
+  if (s.infoJson.isEmpty() || !engine.likeYoutubeDl()) {
+
+    opts.append(url);
+  } else {
+    // the media was extracted when its metadata was fetched
+    opts.append("--load-info-json");
+    opts.append(s.infoJson);
+  }
 
   const auto &ca = engine.cookieArgument();
   const auto &cv = settings.cookieFilePath(engine.name());
@@ -387,9 +396,214 @@ QStringList utility::updateOptions(const updateOptionsStruct &s) {
     utility::arguments(opts).removeOptionWithArgument("--download-archive");
   }
 
+  if (s.rateLimit > 0 && engine.likeYoutubeDl()) {
+
+    // the global limit wins over a rate given in the options
+    utility::arguments(opts).removeOptionWithArgument("-r");
+    utility::arguments(opts).removeOptionWithArgument("--limit-rate");
+
+    opts.append("--limit-rate");
+    opts.append(QString::number(s.rateLimit));
+  }
+
   return opts;
 }
 
+QString utility::infoJsonCache::dir() {
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+         "/infoJson";
+}
+
+QString utility::infoJsonCache::path(const QString &archiveId) {
+  auto m =
+      QCryptographicHash::hash(archiveId.toUtf8(), QCryptographicHash::Sha1);
+
+  return utility::infoJsonCache::dir() + "/" + m.toHex() + ".info.json";
+}
+
+bool utility::infoJsonCache::loadable(const QJsonObject &obj) {
+  // flat playlist entries only point to the media
+  if (obj.value("_type") == "url") {
+
+    return false;
+  }
+
+  return !obj.value("formats").toArray().isEmpty();
+}
+
+bool utility::infoJsonCache::qualified(const QString &archiveId) {
+  // a lone id is not unique across sites, see MediaEntry::archiveId()
+  return archiveId.contains(' ');
+}
+
+QStringList utility::infoJsonCache::writeArguments(const engines::engine &e,
+                                                   settings &s) {
+  // youtube-dl prints the full info dict with -j
+  if (s.infoJsonMaxAge() <= 0 || !e.likeYoutubeDl() ||
+      e.name() == "youtube-dl") {
+
+    return {};
+  }
+
+  auto m = utility::infoJsonCache::dir() +
+           "/written/%(extractor_key)s %(id)s.info.json";
+
+  return {"--print-to-file", "%()j", m};
+}
+
+void utility::infoJsonCache::save(const utility::MediaEntry &media) {
+  auto archiveId = media.archiveId();
+
+  if (!utility::infoJsonCache::qualified(archiveId)) {
+
+    return;
+  }
+
+  auto m = utility::infoJsonCache::path(archiveId);
+
+  QDir().mkpath(QFileInfo(m).absolutePath());
+
+  if (utility::infoJsonCache::loadable(media.doc().object())) {
+
+    QFile file(m);
+
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+
+      file.write(media.doc().toJson(QJsonDocument::Compact));
+    }
+
+    return;
+  }
+
+  // the file yt-dlp wrote for the entry through writeArguments()
+  auto written = utility::infoJsonCache::dir() + "/written/" +
+                 media.extractor() + " " + media.id() + ".info.json";
+
+  if (QFile::exists(written)) {
+
+    QFile::remove(m);
+    QFile::rename(written, m);
+  }
+}
+
+QString utility::infoJsonCache::fresh(const QString &archiveId, settings &s) {
+  auto maxAge = s.infoJsonMaxAge();
+
+  if (!utility::infoJsonCache::qualified(archiveId) || maxAge <= 0) {
+
+    return {};
+  }
+
+  auto m = utility::infoJsonCache::path(archiveId);
+
+  QFileInfo info(m);
+
+  if (!info.exists()) {
+
+    return {};
+  }
+
+  auto age = info.lastModified().secsTo(QDateTime::currentDateTime());
+
+  if (age > maxAge) {
+
+    // the media urls in it have most likely expired
+    QFile::remove(m);
+
+    return {};
+  }
+
+  // only loadable documents are saved, the file is not read here since
+  // this runs every time a download starts
+  return m;
+}
+
+void utility::infoJsonCache::prune(settings &s) {
+  auto maxAge = s.infoJsonMaxAge();
+
+  util::runInBgThread(
+      [maxAge]() {
+        auto oldest = QDateTime::currentDateTime().addSecs(-maxAge);
+
+        auto dir = utility::infoJsonCache::dir();
+
+        for (const auto &path : {dir, dir + "/written"}) {
+
+          const auto files = QDir(path).entryInfoList(QDir::Files);
+
+          for (const auto &it : files) {
+
+            if (it.lastModified() < oldest) {
+
+              QFile::remove(it.absoluteFilePath());
+            }
+          }
+        }
+      },
+      []() {});
+}
+
+utility::bandwidthBudget &utility::bandwidthBudget::instance() {
+  static utility::bandwidthBudget budget;
+
+  return budget;
+}
+
+bool utility::bandwidthBudget::available(settings &s) const {
+  auto limit = s.bandwidthLimit() * 1024;
+
+  // less than 1 KiB/s left would only give a process that crawls
+  return limit <= 0 || limit - this->used() >= 1024;
+}
+
+void utility::bandwidthBudget::wait(std::function<void()> function) {
+  m_waiting.emplace_back(std::move(function));
+}
+
+qint64 utility::bandwidthBudget::acquire(int id, settings &s, size_t share) {
+  auto limit = s.bandwidthLimit() * 1024;
+
+  if (limit <= 0) {
+
+    return 0;
+  }
+
+  auto rate = limit / static_cast<qint64>(std::max(share, size_t(1)));
+
+  rate = std::min(rate, std::max(limit - this->used(), qint64(0)));
+
+  m_allocated[id] = rate;
+
+  return rate;
+}
+
+void utility::bandwidthBudget::release(int id) {
+  if (m_allocated.erase(id) == 0) {
+
+    return;
+  }
+
+  auto waiting = std::move(m_waiting);
+
+  m_waiting.clear();
+
+  for (auto &it : waiting) {
+
+    QTimer::singleShot(0, std::move(it));
+  }
+}
+
+qint64 utility::bandwidthBudget::used() const {
+  qint64 used = 0;
+
+  for (const auto &it : m_allocated) {
+
+    used += it.second;
+  }
+
+  return used;
+}
+
 int utility::concurrentID() {
   static int id = -1;
 
@@ -482,9 +696,25 @@ utility::MediaEntry::MediaEntry(const QString &url, const QByteArray &data)
 
     m_title = object.value("title").toString();
     m_url = object.value("webpage_url").toString();
+
+    if (m_url.isEmpty()) {
+
+      // flat playlist entries are not extracted and only have their url
+      m_url = object.value("url").toString();
+    }
+
     m_uploadDate = object.value("upload_date").toString();
     m_id = object.value("id").toString();
+    // flat playlist entries carry the key of their own extractor in
+    // "ie_key", their "extractor_key" is the one of the playlist
+    m_extractor = object.value("ie_key").toString();
+
+    if (m_extractor.isEmpty()) {
+
+      m_extractor = object.value("extractor_key").toString();
+    }
     m_thumbnailUrl = object.value("thumbnail").toString();
+    m_playlistIndex = object.value("playlist_index").toInt();
 
     if (!m_uploadDate.isEmpty()) {
 
@@ -504,6 +734,16 @@ utility::MediaEntry::MediaEntry(const QString &url, const QByteArray &data)
   }
 }
 
+QString utility::MediaEntry::archiveId() const {
+  if (m_id.isEmpty() || m_extractor.isEmpty()) {
+
+    return m_id;
+  } else {
+    // yt-dlp writes archive entries as "extractor id"
+    return m_extractor.toLower() + " " + m_id;
+  }
+}
+
 QString utility::MediaEntry::uiText() const {
   // resolve title
   auto title = [&]() {
@@ -33,6 +33,7 @@
 #include <QTimer>
 
 #include <iostream>
+#include <map>
 #include <memory>
 #include <type_traits>
 
@@ -243,6 +244,69 @@ struct updateOptionsStruct {
   const QString &indexAsString;
   bool forceDownload;
   const QStringList &urls;
+  qint64 rateLimit = 0;
+  QString infoJson;
+};
+
+/*
+ * Splits the "BandwidthLimit" setting between engine processes that run at
+ * the same time. Rates handed out never add up to more than the limit.
+ *
+ * A rate can not be changed while a process runs, so a process should only
+ * be started when available() says some of the limit is left.
+ */
+class bandwidthBudget {
+public:
+  static bandwidthBudget &instance();
+  bool available(settings &) const;
+  /*
+   * "function" is called once on the next event loop iteration after some
+   * of the limit is released.
+   */
+  void wait(std::function<void()> function);
+  /*
+   * Returns the rate in bytes per second for a new process, or 0 when no
+   * limit is set. "share" is how many processes are expected to run at the
+   * same time.
+   */
+  qint64 acquire(int id, settings &, size_t share);
+  void release(int id);
+
+private:
+  qint64 used() const;
+  std::map<int, qint64> m_allocated;
+  std::vector<std::function<void()>> m_waiting;
+};
+
+class MediaEntry;
+
+/*
+ * Info json of media saved by the metadata stage, keyed by archive id, so a
+ * download can use it instead of extracting the media again.
+ *
+ * Only full info dicts that carry "formats" are kept. youtube-dl prints them
+ * with -j, yt-dlp prints a trimmed document and writes the full one to a
+ * file given by writeArguments() that save() then moves into the cache.
+ */
+class infoJsonCache {
+public:
+  // arguments for the metadata stage of "engine", they may be empty
+  static QStringList writeArguments(const engines::engine &engine,
+                                    settings &);
+  static void save(const utility::MediaEntry &);
+  /*
+   * Returns the path to the info json of "archiveId" if it is younger than
+   * "InfoJsonMaxAge", an empty string otherwise.
+   */
+  static QString fresh(const QString &archiveId, settings &);
+  // removes expired files on a background thread
+  static void prune(settings &);
+
+private:
+  static bool loadable(const QJsonObject &);
+  static bool qualified(const QString &archiveId);
+  static QString dir();
+  static QString path(const QString &archiveId);
 };
 
 QStringList updateOptions(const updateOptionsStruct &);
@@ -510,7 +574,7 @@ public:
               [function = std::move(function)](int index) { function(index); });
         });
   }
-  void terminateAll(QTableWidget &t) {
+  void terminateAll(const tableWidget &t) {
     for (int i = 0; i < t.rowCount(); i++) {
 
       this->terminate(i);
@@ -685,6 +749,10 @@ public:
 
     m_timer->stop();
 
+    // progress still waiting for the next tick must be shown before the
+    // finished state is
+    m_logger.flush();
+
     if (m_options.listRequested()) {
 
       m_options.listRequested(std::move(m_data));
@@ -865,7 +933,10 @@ public:
   QString errorString() const { return m_json.errorString(); }
   const QString &duration() const { return m_duration; }
   const QString &id() const { return m_id; }
+  const QString &extractor() const { return m_extractor; }
+  QString archiveId() const;
   int intDuration() const { return m_intDuration; }
+  int playlistIndex() const { return m_playlistIndex; }
 
 private:
   QString m_thumbnailUrl;
@@ -874,7 +945,9 @@ private:
   QString m_url;
   QString m_duration;
   QString m_id;
+  QString m_extractor;
   int m_intDuration;
+  int m_playlistIndex = 0;
   util::Json m_json;
 };
 
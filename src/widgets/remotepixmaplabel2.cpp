@@ -1,5 +1,7 @@
 #include "remotepixmaplabel2.h"
+#include "../thumbnailcache.h"
 #include <QDebug>
+#include <QPointer>
 
 QString reloadIcon64 =
     "iVBORw0KGgoAAAANSUhEUgAAAEAAAABACAYAAACqaXHeAAAABmJLR0QAaAAWAGOcEWjTAAAACX"
@@ -87,17 +89,21 @@ void RemotePixmapLabel2::pixmapReceived() {
   } else {
     const QByteArray data(reply->readAll());
     if (data.size() != 0) {
-      QPixmap pixmap;
-      pixmap.loadFromData(data);
-      setPixmap(pixmap.scaled(this->size(), Qt::KeepAspectRatio,
-                              Qt::SmoothTransformation));
-      // check for currupt pixmap
-      if (pixmap.isNull() == false) {
-        emit pixmapLoaded(data);
-        networkManager_ = nullptr;
-      } else {
-        qDebug() << Q_FUNC_INFO << "pixmap currupt";
-      }
+      QPointer<RemotePixmapLabel2> label(this);
+      thumbnailCache::instance().decode(
+          data, this->size(), [label, data](const QImage &image) {
+            // the label may be gone by the time the image is decoded
+            if (label.isNull())
+              return;
+            // check for currupt pixmap
+            if (image.isNull() == false) {
+              label->setPixmap(QPixmap::fromImage(image));
+              emit label->pixmapLoaded(data);
+              label->networkManager_ = nullptr;
+            } else {
+              qDebug() << Q_FUNC_INFO << "pixmap currupt";
+            }
+          });
     } else {
       qDebug() << Q_FUNC_INFO
                << "network okay, but received pixmap looks like nothing";